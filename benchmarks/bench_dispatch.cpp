@@ -0,0 +1,101 @@
+#include "glib-senders/glib_io_context.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace gsenders;
+
+namespace {
+constexpr std::size_t batch_size = 32;
+
+// Every index yields a distinct receiver type and thus its own instantiation
+// of the operation states. Compare the .text size of this binary (size -A)
+// between builds to see the effect of the operation cores on code size.
+template <std::size_t I>
+auto hop(glib_scheduler scheduler, std::size_t& count) {
+  return stdexec::schedule(scheduler) | stdexec::then([&count] { ++count; });
+}
+
+template <std::size_t... Is>
+auto start_hops(glib_scheduler scheduler, std::size_t& count,
+                std::index_sequence<Is...>) -> void {
+  (stdexec::start_detached(hop<Is>(scheduler, count)), ...);
+}
+
+auto run_until(const std::size_t& count, std::size_t expected) -> void {
+  while (count < expected) {
+    ::g_main_context_iteration(::g_main_context_default(), true);
+  }
+}
+
+template <class Fn>
+auto measure(const char* name, std::size_t iterations, Fn fn) -> void {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+  std::cout << name << ": " << ns.count() / iterations << " ns/op\n";
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000;
+  std::size_t iterations = rounds * batch_size;
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  std::size_t count = 0;
+
+  measure("schedule, GSource", iterations, [&] {
+    for (std::size_t i = 0; i < rounds; ++i) {
+      start_hops(scheduler, count, std::make_index_sequence<batch_size>{});
+      run_until(count, (i + 1) * batch_size);
+    }
+  });
+
+  count = 0;
+  measure("schedule, inline", iterations, [&] {
+    for (std::size_t i = 0; i < rounds; ++i) {
+      // Started from within a dispatch, such that all hops take the run queue.
+      stdexec::start_detached(
+          stdexec::schedule(scheduler) | stdexec::then([&] {
+            start_hops(scheduler, count,
+                       std::make_index_sequence<batch_size>{});
+          }));
+      run_until(count, (i + 1) * batch_size);
+    }
+  });
+
+  int fd = ::eventfd(1, EFD_NONBLOCK);
+  if (fd == -1) {
+    std::perror("eventfd");
+    return EXIT_FAILURE;
+  }
+  count = 0;
+  measure("wait_until, ready fd", iterations, [&] {
+    for (std::size_t i = 0; i < iterations; ++i) {
+      stdexec::start_detached(
+          wait_until(scheduler, fd, io_condition::is_readable) |
+          stdexec::then([&](int) { ++count; }));
+      run_until(count, i + 1);
+    }
+  });
+  ::close(fd);
+
+  count = 0;
+  measure("schedule_after, 0ms", iterations, [&] {
+    for (std::size_t i = 0; i < iterations; ++i) {
+      stdexec::start_detached(
+          exec::schedule_after(scheduler, std::chrono::milliseconds(0)) |
+          stdexec::then([&] { ++count; }));
+      run_until(count, i + 1);
+    }
+  });
+}
@@ -0,0 +1,167 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/task.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace gsenders;
+
+namespace {
+using steady_clock = std::chrono::steady_clock;
+
+struct options {
+  std::string host = "127.0.0.1";
+  std::uint16_t port = 7777;
+  std::size_t connections = 64;
+  std::size_t message_size = 64;
+  std::chrono::seconds duration{10};
+};
+
+task<safe_file_descriptor> open_connection(glib_scheduler scheduler,
+                                   const options& opts) {
+  safe_file_descriptor fd{
+      ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+  int on = 1;
+  ::setsockopt(fd.get(), IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(opts.port);
+  if (::inet_pton(AF_INET, opts.host.c_str(), &address.sin_addr) != 1) {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+  }
+  if (::connect(fd.get(), reinterpret_cast<sockaddr*>(&address),
+                sizeof(address)) == -1) {
+    if (errno != EINPROGRESS) {
+      throw std::system_error(errno, std::system_category());
+    }
+    co_await wait_until(scheduler, fd.get(), io_condition::is_writeable);
+    int error = 0;
+    socklen_t length = sizeof(error);
+    ::getsockopt(fd.get(), SOL_SOCKET, SO_ERROR, &error, &length);
+    if (error != 0) {
+      throw std::system_error(error, std::system_category());
+    }
+  }
+  co_return fd;
+}
+
+// Sends one message at a time and records the round-trip time of each.
+task<void> run_connection(glib_scheduler scheduler, const options& opts,
+                          steady_clock::time_point deadline,
+                          std::vector<steady_clock::duration>& latencies) {
+  safe_file_descriptor socket = co_await open_connection(scheduler, opts);
+  file_descriptor fd{scheduler, socket.get()};
+  std::vector<char> message(opts.message_size, 'x');
+  std::vector<char> reply(opts.message_size);
+  while (steady_clock::now() < deadline) {
+    steady_clock::time_point start = steady_clock::now();
+    std::span<const char> to_send = message;
+    while (!to_send.empty()) {
+      to_send = co_await async_write_some(fd, to_send);
+    }
+    std::size_t received = 0;
+    while (received < reply.size()) {
+      std::span<char> chunk = co_await async_read_some(
+          fd, std::span<char>(reply).subspan(received));
+      if (chunk.empty()) {
+        throw std::system_error(
+            std::make_error_code(std::errc::connection_reset));
+      }
+      received += chunk.size();
+    }
+    latencies.push_back(steady_clock::now() - start);
+  }
+}
+
+auto percentile(const std::vector<steady_clock::duration>& sorted, double p)
+    -> std::chrono::microseconds {
+  if (sorted.empty()) {
+    return {};
+  }
+  auto index = std::min(sorted.size() - 1,
+                        static_cast<std::size_t>(p * sorted.size()));
+  return std::chrono::duration_cast<std::chrono::microseconds>(sorted[index]);
+}
+
+auto parse(int argc, char** argv) -> options {
+  options opts{};
+  if (argc > 1) {
+    opts.host = argv[1];
+  }
+  if (argc > 2) {
+    opts.port = static_cast<std::uint16_t>(std::strtoul(argv[2], nullptr, 10));
+  }
+  if (argc > 3) {
+    opts.connections = std::strtoul(argv[3], nullptr, 10);
+  }
+  if (argc > 4) {
+    opts.message_size = std::max<std::size_t>(
+        1, std::strtoul(argv[4], nullptr, 10));
+  }
+  if (argc > 5) {
+    opts.duration = std::chrono::seconds(std::strtoul(argv[5], nullptr, 10));
+  }
+  return opts;
+}
+} // namespace
+
+// Usage: bench_echo_client [host] [port] [connections] [message size]
+//                          [duration in seconds]
+int main(int argc, char** argv) {
+  options opts = parse(argc, argv);
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  std::vector<std::vector<steady_clock::duration>> latencies(
+      opts.connections);
+  std::size_t running = opts.connections;
+  std::size_t failed = 0;
+
+  steady_clock::time_point start = steady_clock::now();
+  steady_clock::time_point deadline = start + opts.duration;
+  for (auto& connection_latencies : latencies) {
+    stdexec::start_detached(
+        stdexec::on(scheduler,
+                    run_connection(scheduler, opts, deadline,
+                                   connection_latencies)) |
+        stdexec::upon_error([&](std::exception_ptr) { ++failed; }) |
+        stdexec::then([&] {
+          if (--running == 0) {
+            ctx.stop();
+          }
+        }));
+  }
+  ctx.run();
+  auto elapsed = std::chrono::duration<double>(steady_clock::now() - start);
+
+  std::vector<steady_clock::duration> all{};
+  for (const auto& connection_latencies : latencies) {
+    all.insert(all.end(), connection_latencies.begin(),
+               connection_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  std::cout << "connections:  " << opts.connections << " (" << failed
+            << " failed)\n"
+            << "message size: " << opts.message_size << " bytes\n"
+            << "requests:     " << all.size() << '\n'
+            << "requests/s:   "
+            << static_cast<std::size_t>(all.size() / elapsed.count()) << '\n'
+            << "p50:          " << percentile(all, 0.50).count() << " us\n"
+            << "p99:          " << percentile(all, 0.99).count() << " us\n"
+            << "p999:         " << percentile(all, 0.999).count() << " us\n";
+}
@@ -0,0 +1,93 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/task.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace gsenders;
+
+namespace {
+auto make_listener(std::uint16_t port) -> safe_file_descriptor {
+  safe_file_descriptor fd{
+      ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+  int on = 1;
+  ::setsockopt(fd.get(), SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (::bind(fd.get(), reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) == -1 ||
+      ::listen(fd.get(), SOMAXCONN) == -1) {
+    throw std::system_error(errno, std::system_category());
+  }
+  return fd;
+}
+
+task<void> write_all(file_descriptor fd, std::span<const char> buffer) {
+  while (!buffer.empty()) {
+    buffer = co_await async_write_some(fd, buffer);
+  }
+}
+
+task<void> session(glib_scheduler scheduler, safe_file_descriptor socket) {
+  file_descriptor fd{scheduler, socket.get()};
+  char buffer[64 * 1024];
+  try {
+    while (true) {
+      std::span<char> received = co_await async_read_some(fd, buffer);
+      if (received.empty()) {
+        break;
+      }
+      co_await write_all(fd, received);
+    }
+  } catch (const std::exception& error) {
+    std::cerr << "session: " << error.what() << '\n';
+  }
+}
+
+task<void> serve(glib_scheduler scheduler, int listener) {
+  while (true) {
+    co_await wait_until(scheduler, listener, io_condition::is_readable);
+    while (true) {
+      int client = ::accept4(listener, nullptr, nullptr,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (client == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          std::perror("accept4");
+        }
+        break;
+      }
+      int on = 1;
+      ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+      stdexec::start_detached(
+          session(scheduler, safe_file_descriptor{client}));
+    }
+  }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  auto port = static_cast<std::uint16_t>(
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 7777);
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  safe_file_descriptor listener = make_listener(port);
+  std::cout << "Echo server listening on port " << port << '\n';
+
+  stdexec::start_detached(
+      stdexec::on(scheduler, serve(scheduler, listener.get())));
+  ctx.run();
+}
@@ -0,0 +1,62 @@
+# FindGio
+# -------
+#
+# Try to locate the GIO library.
+# If found, this will define the following variables:
+#
+# ``Gio_FOUND``
+# True if the GIO library is available
+# ``Gio_INCLUDE_DIRS``
+# The GIO include directories
+# ``Gio_LIBRARIES``
+# The GIO and GObject libraries for linking
+#
+# If ``Gio_FOUND`` is TRUE, it will also define the following
+# imported target:
+#
+# ``Gio::Gio``
+# The GIO library, which links GObject and GLib
+
+find_package(Glib QUIET)
+find_package(PkgConfig)
+pkg_check_modules(PC_Gio QUIET gio-2.0)
+
+find_path(Gio_INCLUDE_DIR
+  NAMES gio/gio.h
+  HINTS ${PC_Gio_INCLUDEDIR} ${PC_Gio_INCLUDE_DIRS}
+  PATH_SUFFIXES glib-2.0)
+
+find_library(Gio_LIBRARY
+  NAMES gio-2.0
+  HINTS ${PC_Gio_LIBDIR} ${PC_Gio_LIBRARY_DIRS})
+
+find_library(Gio_GOBJECT_LIBRARY
+  NAMES gobject-2.0
+  HINTS ${PC_Gio_LIBDIR} ${PC_Gio_LIBRARY_DIRS})
+
+set(Gio_INCLUDE_DIRS "${Gio_INCLUDE_DIR}")
+set(Gio_LIBRARIES "${Gio_LIBRARY}" "${Gio_GOBJECT_LIBRARY}")
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Gio DEFAULT_MSG
+  Gio_LIBRARY Gio_GOBJECT_LIBRARY Gio_INCLUDE_DIR Glib_FOUND)
+
+if(Gio_FOUND AND NOT TARGET Gio::Gio)
+  add_library(Gio::GObject UNKNOWN IMPORTED)
+  set_target_properties(Gio::GObject PROPERTIES
+    IMPORTED_LOCATION "${Gio_GOBJECT_LIBRARY}"
+    INTERFACE_LINK_LIBRARIES Glib::Glib)
+
+  add_library(Gio::Gio UNKNOWN IMPORTED)
+  set_target_properties(Gio::Gio PROPERTIES
+    IMPORTED_LOCATION "${Gio_LIBRARY}"
+    INTERFACE_INCLUDE_DIRECTORIES "${Gio_INCLUDE_DIRS}"
+    INTERFACE_LINK_LIBRARIES Gio::GObject)
+endif()
+
+mark_as_advanced(Gio_INCLUDE_DIR Gio_LIBRARY Gio_GOBJECT_LIBRARY)
+
+include(FeatureSummary)
+set_package_properties(Gio PROPERTIES
+  URL "https://docs.gtk.org/gio/"
+  DESCRIPTION "Stream, socket and TLS library on top of GLib")
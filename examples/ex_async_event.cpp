@@ -0,0 +1,35 @@
+#include "glib-senders/async_event.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+#include <iostream>
+#include <thread>
+
+using namespace gsenders;
+
+int main() {
+  glib_io_context ctx{};
+  async_event event{ctx.get_scheduler()};
+  async_semaphore semaphore{ctx.get_scheduler()};
+
+  std::thread producer{[&] {
+    // Coalesced into a single wakeup of the event loop
+    for (int i = 0; i < 1000000; ++i) {
+      event.notify();
+    }
+    semaphore.release(2);
+  }};
+
+  auto print = [](const char* what) {
+    return stdexec::then([what] { std::cout << what << '\n'; });
+  };
+
+  stdexec::start_detached(
+      stdexec::when_all(event.wait() | print("Notified"),
+                        event.wait() | print("Notified"),
+                        semaphore.acquire() | print("Acquired"),
+                        semaphore.acquire() | print("Acquired")) |
+      stdexec::then([&] { ctx.stop(); }));
+
+  ctx.run();
+  producer.join();
+}
@@ -0,0 +1,20 @@
+#include "glib-senders/broadcast_channel.hpp"
+
+#include <iostream>
+#include <string>
+
+int main() {
+  gsenders::broadcast_channel<std::string> channel{
+      4, gsenders::broadcast_policy::backpressure};
+  auto first = channel.subscribe();
+  auto second = channel.subscribe();
+
+  auto [a, b] =
+      stdexec::sync_wait(
+          stdexec::when_all(first.receive(), second.receive(),
+                            channel.send(std::string("tick"))))
+          .value();
+
+  // Both subscribers share the same payload.
+  std::cout << *a << ' ' << *b << ' ' << (a == b) << '\n';
+}
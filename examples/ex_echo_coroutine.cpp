@@ -1,18 +1,18 @@
 #include "glib-senders/glib_io_context.hpp"
 #include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/task.hpp"
 
 #include <iostream>
-#include <exec/task.hpp>
 
 using namespace gsenders;
 
-exec::task<void> write(file_descriptor fd, std::span<const char> buffer) {
+task<void> write(file_descriptor fd, std::span<const char> buffer) {
   while (!buffer.empty()) {
     buffer = co_await async_write_some(fd, buffer);
   }
 } 
 
-exec::task<void> echo(file_descriptor in, file_descriptor out) {
+task<void> echo(file_descriptor in, file_descriptor out) {
   char buffer[1024];
   int n = 0;
   for (int n = 0; n < 10; ++n) {
@@ -0,0 +1,61 @@
+#include "glib-senders/gio_stream.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/task.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace gsenders;
+
+// Copies a file. The GBytes that have been read are written as they are.
+task<void> copy(input_stream in, output_stream out) {
+  while (true) {
+    bytes chunk = co_await async_read_bytes(in, 64 * 1024);
+    if (chunk.empty()) {
+      break;
+    }
+    while (!chunk.empty()) {
+      std::size_t nbytes = co_await async_write_bytes(out, chunk);
+      if (nbytes < chunk.size()) {
+        chunk = bytes{::g_bytes_new_from_bytes(chunk.native_handle(), nbytes,
+                                               chunk.size() - nbytes)};
+      } else {
+        chunk = bytes{};
+      }
+    }
+  }
+  co_await async_close(out);
+  co_await async_close(in);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <source> <destination>\n";
+    return EXIT_FAILURE;
+  }
+  GError* error = nullptr;
+  GFile* source = ::g_file_new_for_path(argv[1]);
+  GFile* destination = ::g_file_new_for_path(argv[2]);
+  GFileInputStream* in = ::g_file_read(source, nullptr, &error);
+  GFileOutputStream* out =
+      in ? ::g_file_replace(destination, nullptr, false, G_FILE_CREATE_NONE,
+                            nullptr, &error)
+         : nullptr;
+  if (error) {
+    std::cerr << error->message << '\n';
+    return EXIT_FAILURE;
+  }
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  stdexec::start_detached(stdexec::on(
+      scheduler, copy(input_stream{scheduler, G_INPUT_STREAM(in)},
+                      output_stream{scheduler, G_OUTPUT_STREAM(out)}) |
+                     stdexec::then([&] { ctx.stop(); })));
+  ctx.run();
+
+  g_object_unref(out);
+  g_object_unref(in);
+  g_object_unref(destination);
+  g_object_unref(source);
+}
@@ -0,0 +1,32 @@
+#include "glib-senders/glib_io_context.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace gsenders;
+
+int main() {
+  using namespace std::chrono_literals;
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  idle_scheduler idle = ctx.get_idle_scheduler(2ms);
+
+  // Each idle dispatch runs about two of these jobs before the loop gets the
+  // chance to serve the timer again.
+  int remaining = 20;
+  for (int i = 0; i < 20; ++i) {
+    stdexec::start_detached(stdexec::schedule(idle) | stdexec::then([&, i] {
+                              std::this_thread::sleep_for(1ms);
+                              std::cout << "background job " << i << '\n';
+                              if (--remaining == 0) {
+                                ctx.stop();
+                              }
+                            }));
+  }
+  stdexec::start_detached(exec::schedule_after(scheduler, 5ms) |
+                          stdexec::then([] { std::cout << "timer\n"; }));
+
+  ctx.run();
+}
@@ -0,0 +1,35 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/mapped_file.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <exec/task.hpp>
+
+using namespace gsenders;
+
+exec::task<std::size_t> count_lines(mapped_file_stream& stream) {
+  std::size_t lines = 0;
+  std::span<const char> window = co_await async_next_window(stream);
+  while (!window.empty()) {
+    lines += std::count(window.begin(), window.end(), '\n');
+    window = co_await async_next_window(stream);
+  }
+  co_return lines;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file>\n";
+    return 1;
+  }
+  glib_io_context ctx{};
+  mapped_file file{argv[1]};
+  mapped_file_stream stream{ctx.get_scheduler(), file};
+  auto print_and_stop = stdexec::then([&](std::size_t n) {
+    std::cout << n << " lines\n";
+    ctx.stop();
+  });
+  stdexec::start_detached(
+      stdexec::on(ctx.get_scheduler(), count_lines(stream) | print_and_stop));
+  ctx.run();
+}
@@ -0,0 +1,44 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/io_thread_pool.hpp"
+
+#include <fcntl.h>
+
+#include <iostream>
+#include <string_view>
+
+using namespace gsenders;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file>\n";
+    return 1;
+  }
+  glib_io_context ctx{};
+  io_thread_pool pool{ctx.get_scheduler()};
+  safe_file_descriptor fd{::open(argv[1], O_RDONLY | O_CLOEXEC)};
+  if (!fd) {
+    return 1;
+  }
+
+  char head[64];
+  char tail[64];
+  pread_request requests[] = {{head, 0}, {tail, 4096}};
+
+  stdexec::start_detached(
+      stdexec::when_all(
+          async_pread(pool, fd.get(), head, 0) |
+              stdexec::then([](std::span<char> data) {
+                std::cout << "Read " << data.size() << " bytes\n";
+              }),
+          async_pread(pool, fd.get(), std::span{requests}) |
+              stdexec::then([](std::span<pread_request> batch) {
+                for (const pread_request& request : batch) {
+                  std::cout << "Read " << request.result.size()
+                            << " bytes at offset " << request.offset << '\n';
+                }
+              })) |
+      stdexec::then([&] { ctx.stop(); }));
+
+  ctx.run();
+}
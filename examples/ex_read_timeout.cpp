@@ -0,0 +1,25 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+#include <iostream>
+
+namespace ex = stdexec;
+
+int main() {
+  using namespace gsenders;
+  using namespace std::chrono_literals;
+
+  glib_io_context context{};
+  file_descriptor fd{context.get_scheduler(), STDIN_FILENO};
+  char buffer[128];
+
+  ex::start_detached( //
+      async_read_some(fd, buffer, 1s) //
+      | ex::then([](std::span<char> span) {
+          std::cout << "Read " << span.size() << " bytes\n";
+        }) //
+      | ex::upon_error([](std::exception_ptr) { std::cout << "Timeout\n"; }) //
+      | ex::then([&context] { context.stop(); }));
+
+  context.run();
+}
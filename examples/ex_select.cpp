@@ -0,0 +1,54 @@
+#include "glib-senders/broadcast_channel.hpp"
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/select.hpp"
+#include "glib-senders/task.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace gsenders;
+
+task<void> run(selector& sel, std::size_t input,
+               broadcast_channel<std::string>::subscription& ticks) {
+  file_descriptor in{STDIN_FILENO};
+  char buffer[1024];
+  for (int n = 0; n < 5;) {
+    std::size_t index = co_await sel.select();
+    if (index == input) {
+      std::span<char> received = co_await async_read_some(in, buffer);
+      std::cout << "stdin: " << std::string_view(received.data(), received.size());
+    } else {
+      auto tick = co_await ticks.receive();
+      std::cout << *tick << '\n';
+      ++n;
+    }
+  }
+}
+
+int main() {
+  using namespace std::chrono_literals;
+
+  glib_io_context ctx{};
+  broadcast_channel<std::string> channel{};
+  auto ticks = channel.subscribe();
+
+  selector sel{ctx.get_scheduler()};
+  std::size_t input = sel.add(STDIN_FILENO, io_condition::is_readable);
+  sel.add(ticks);
+
+  std::thread producer{[&] {
+    for (int i = 0; i < 5; ++i) {
+      std::this_thread::sleep_for(500ms);
+      stdexec::sync_wait(channel.send("tick " + std::to_string(i)));
+    }
+  }};
+
+  stdexec::start_detached(stdexec::on(
+      ctx.get_scheduler(),
+      run(sel, input, ticks) | stdexec::then([&] { ctx.stop(); })));
+  ctx.run();
+  producer.join();
+}
@@ -0,0 +1,79 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/shm_channel.hpp"
+#include "glib-senders/task.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace gsenders;
+
+constexpr int message_count = 100'000;
+constexpr std::size_t message_size = 4096;
+
+// Writes each message in place and ends the stream with an empty message.
+task<void> produce(shm_producer& producer) {
+  for (int i = 0; i < message_count; ++i) {
+    std::span<char> message = co_await producer.reserve(message_size);
+    std::memset(message.data(), 'a' + i % 26, message.size());
+    std::memcpy(message.data(), &i, sizeof(i));
+    producer.commit(message.size());
+  }
+  co_await producer.reserve(0);
+  producer.commit(0);
+}
+
+task<void> consume(shm_consumer& consumer) {
+  std::uint64_t total = 0;
+  int count = 0;
+  while (true) {
+    std::span<const char> message = co_await consumer.receive();
+    if (message.empty()) {
+      consumer.release();
+      break;
+    }
+    int index = 0;
+    std::memcpy(&index, message.data(), sizeof(index));
+    if (index != count) {
+      std::fprintf(stderr, "expected message %d, got %d\n", count, index);
+    }
+    total += message.size();
+    ++count;
+    consumer.release();
+  }
+  std::printf("child: received %d messages, %llu bytes\n", count,
+              static_cast<unsigned long long>(total));
+}
+
+int main() {
+  // The channel is created before the fork, the child inherits the mapping
+  // and the eventfds. Each process runs its own event loop afterwards.
+  shm_channel channel{};
+  pid_t pid = ::fork();
+  if (pid == -1) {
+    std::perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    glib_io_context ctx{};
+    shm_consumer consumer{ctx.get_scheduler(), channel};
+    stdexec::start_detached(
+        stdexec::on(ctx.get_scheduler(),
+                    consume(consumer) | stdexec::then([&] { ctx.stop(); })));
+    ctx.run();
+    return 0;
+  }
+  glib_io_context ctx{};
+  shm_producer producer{ctx.get_scheduler(), channel};
+  stdexec::start_detached(
+      stdexec::on(ctx.get_scheduler(),
+                  produce(producer) | stdexec::then([&] { ctx.stop(); })));
+  ctx.run();
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  std::printf("parent: sent %d messages\n", message_count);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
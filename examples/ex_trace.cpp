@@ -0,0 +1,26 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/trace.hpp"
+
+#include <iostream>
+
+using namespace gsenders;
+
+int main() {
+  using namespace std::chrono_literals;
+
+  if constexpr (!tracing_enabled) {
+    std::cout << "Configure with -DGLIB_SENDERS_TRACING=ON to record events\n";
+  }
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+
+  auto hop = stdexec::schedule(scheduler) | stdexec::then([] {});
+  stdexec::start_detached(
+      stdexec::when_all(hop, hop, exec::schedule_after(scheduler, 10ms)) |
+      stdexec::then([&] { ctx.stop(); }));
+
+  ctx.run();
+
+  dump_chrome_trace("glib-senders-trace.json");
+}
@@ -0,0 +1,65 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/task.hpp"
+#include "glib-senders/write_queue.hpp"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace gsenders;
+
+// Every writer queues its lines without waiting for the fd. Lines from all
+// writers that are queued within one loop iteration go out in one writev.
+task<void> writer(write_queue& queue, int id) {
+  for (int i = 0; i < 100; ++i) {
+    std::string line =
+        "writer " + std::to_string(id) + " line " + std::to_string(i) + '\n';
+    co_await async_send(queue, line);
+  }
+}
+
+// The write end is closed after the queue is gone, which lets the reader see
+// the end of the stream.
+task<void> write_all(glib_scheduler scheduler,
+                     safe_file_descriptor write_end) {
+  write_queue queue{scheduler, write_end.get()};
+  co_await stdexec::when_all(writer(queue, 1), writer(queue, 2),
+                             writer(queue, 3));
+  co_await queue.flush();
+}
+
+task<void> read_all(file_descriptor read_end) {
+  char buffer[4096];
+  while (true) {
+    std::span<char> received = co_await async_read_some(read_end, buffer);
+    if (received.empty()) {
+      break;
+    }
+    std::cout << std::string_view{received.data(), received.size()};
+  }
+}
+
+int main() {
+  // A pipe instead of stdout, whose file description is shared with the
+  // terminal and must not be switched to non-blocking mode.
+  int fds[2];
+  if (::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == -1) {
+    return 1;
+  }
+  safe_file_descriptor read_end{fds[0]};
+  safe_file_descriptor write_end{fds[1]};
+
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  stdexec::start_detached(stdexec::on(
+      scheduler,
+      stdexec::when_all(write_all(scheduler, std::move(write_end)),
+                        read_all(file_descriptor{scheduler, read_end.get()})) |
+          stdexec::then([&] { ctx.stop(); })));
+  ctx.run();
+}
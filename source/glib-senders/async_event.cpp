@@ -0,0 +1,240 @@
+#include "glib-senders/async_event.hpp"
+
+#include <cstdint>
+#include <system_error>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace gsenders {
+
+eventfd_notifier::eventfd_notifier()
+    : fd_{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)} {
+  if (!fd_) {
+    throw std::system_error(errno, std::system_category());
+  }
+}
+
+auto eventfd_notifier::notify() noexcept -> void {
+  if (!notified_.exchange(true)) {
+    std::uint64_t one = 1;
+    [[maybe_unused]] ssize_t nbytes = ::write(fd_.get(), &one, sizeof(one));
+  }
+}
+
+auto eventfd_notifier::reset() noexcept -> void {
+  notified_.store(false);
+  std::uint64_t value = 0;
+  [[maybe_unused]] ssize_t nbytes = ::read(fd_.get(), &value, sizeof(value));
+  // A notify() between the store and the read may have been drained by us.
+  if (notified_.load()) {
+    std::uint64_t one = 1;
+    nbytes = ::write(fd_.get(), &one, sizeof(one));
+  }
+}
+
+auto eventfd_notifier::native_handle() const noexcept -> int {
+  return fd_.get();
+}
+
+async_event::async_event(glib_scheduler scheduler) : scheduler_{scheduler} {
+  source_ = make_ready_time_source(&async_event::dispatch, this);
+  // Polled only while a waiter is pending, see dispatch().
+  tag_ = ::g_source_add_unix_fd(source_, notifier_.native_handle(),
+                                ::GIOCondition{});
+  ::g_source_attach(source_, scheduler_.get_GMainContext());
+}
+
+async_event::~async_event() {
+  ::g_source_destroy(source_);
+  ::g_source_unref(source_);
+}
+
+auto async_event::start(event_waiter* waiter) noexcept -> void {
+  bool was_empty = false;
+  {
+    std::lock_guard lock{mutex_};
+    was_empty = head_ == nullptr;
+    if (tail_) {
+      tail_->next_ = waiter;
+    } else {
+      head_ = waiter;
+    }
+    tail_ = waiter;
+  }
+  // The first waiter enables polling of the eventfd from the next dispatch,
+  // which may run on another thread.
+  if (was_empty) {
+    make_source_ready(source_);
+  }
+}
+
+auto async_event::request_stop(event_waiter* waiter) noexcept -> void {
+  waiter->stop_requested_.store(true);
+  make_source_ready(source_);
+}
+
+auto async_event::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<async_event*>(data);
+  ::g_source_set_ready_time(self.source_, -1);
+  bool notified = ::g_source_query_unix_fd(self.source_, self.tag_) != 0;
+  if (notified) {
+    // Once per readiness. Every waiter that is queued below consumes it.
+    self.notifier_.reset();
+  }
+  event_waiter* ready = nullptr;
+  event_waiter* stopped = nullptr;
+  bool has_waiters = false;
+  {
+    std::lock_guard lock{self.mutex_};
+    event_waiter* remaining_head = nullptr;
+    event_waiter* remaining_tail = nullptr;
+    event_waiter* ready_tail = nullptr;
+    while (self.head_) {
+      event_waiter* waiter = std::exchange(self.head_, self.head_->next_);
+      waiter->next_ = nullptr;
+      if (notified) {
+        (ready_tail ? ready_tail->next_ : ready) = waiter;
+        ready_tail = waiter;
+      } else if (waiter->stop_requested_.load()) {
+        waiter->next_ = stopped;
+        stopped = waiter;
+      } else {
+        (remaining_tail ? remaining_tail->next_ : remaining_head) = waiter;
+        remaining_tail = waiter;
+      }
+    }
+    self.head_ = remaining_head;
+    self.tail_ = remaining_tail;
+    has_waiters = self.head_ != nullptr;
+  }
+  ::g_source_modify_unix_fd(self.source_, self.tag_,
+                            has_waiters ? G_IO_IN : ::GIOCondition{});
+  // The event may be destroyed by a completion, it is not touched anymore.
+  while (stopped) {
+    event_waiter* waiter = std::exchange(stopped, stopped->next_);
+    waiter->complete_(waiter, true);
+  }
+  while (ready) {
+    event_waiter* waiter = std::exchange(ready, ready->next_);
+    waiter->complete_(waiter, false);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+async_semaphore::async_semaphore(glib_scheduler scheduler,
+                                 std::size_t initial_count)
+    : scheduler_{scheduler}, count_{initial_count} {
+  source_ = make_ready_time_source(&async_semaphore::dispatch, this);
+  // Polled only while a waiter is pending, see dispatch().
+  tag_ = ::g_source_add_unix_fd(source_, notifier_.native_handle(),
+                                ::GIOCondition{});
+  ::g_source_attach(source_, scheduler_.get_GMainContext());
+}
+
+async_semaphore::~async_semaphore() {
+  ::g_source_destroy(source_);
+  ::g_source_unref(source_);
+}
+
+auto async_semaphore::release(std::size_t n) noexcept -> void {
+  bool has_waiters = false;
+  {
+    std::lock_guard lock{mutex_};
+    count_ += n;
+    has_waiters = head_ != nullptr;
+  }
+  if (has_waiters) {
+    notifier_.notify();
+  }
+}
+
+auto async_semaphore::try_acquire() noexcept -> bool {
+  std::lock_guard lock{mutex_};
+  if (head_ || count_ == 0) {
+    return false;
+  }
+  --count_;
+  return true;
+}
+
+auto async_semaphore::start(event_waiter* waiter) noexcept -> void {
+  bool acquired = false;
+  bool was_empty = false;
+  {
+    std::lock_guard lock{mutex_};
+    was_empty = head_ == nullptr;
+    if (was_empty && count_ > 0) {
+      --count_;
+      acquired = true;
+    } else if (tail_) {
+      tail_->next_ = waiter;
+      tail_ = waiter;
+    } else {
+      head_ = tail_ = waiter;
+    }
+  }
+  if (acquired) {
+    waiter->complete_(waiter, false);
+  } else if (was_empty) {
+    // The first waiter enables polling of the eventfd, see async_event.
+    make_source_ready(source_);
+  }
+}
+
+auto async_semaphore::request_stop(event_waiter* waiter) noexcept -> void {
+  waiter->stop_requested_.store(true);
+  make_source_ready(source_);
+}
+
+// Stopped waiters are removed first, such that they do not take a unit. The
+// remaining ones get the available units in queue order.
+auto async_semaphore::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<async_semaphore*>(data);
+  ::g_source_set_ready_time(self.source_, -1);
+  if (::g_source_query_unix_fd(self.source_, self.tag_) != 0) {
+    self.notifier_.reset();
+  }
+  event_waiter* ready = nullptr;
+  event_waiter* stopped = nullptr;
+  bool has_waiters = false;
+  {
+    std::lock_guard lock{self.mutex_};
+    event_waiter* remaining_head = nullptr;
+    event_waiter* remaining_tail = nullptr;
+    event_waiter* ready_tail = nullptr;
+    while (self.head_) {
+      event_waiter* waiter = std::exchange(self.head_, self.head_->next_);
+      waiter->next_ = nullptr;
+      if (waiter->stop_requested_.load()) {
+        waiter->next_ = stopped;
+        stopped = waiter;
+      } else if (self.count_ > 0) {
+        --self.count_;
+        (ready_tail ? ready_tail->next_ : ready) = waiter;
+        ready_tail = waiter;
+      } else {
+        (remaining_tail ? remaining_tail->next_ : remaining_head) = waiter;
+        remaining_tail = waiter;
+      }
+    }
+    self.head_ = remaining_head;
+    self.tail_ = remaining_tail;
+    has_waiters = self.head_ != nullptr;
+  }
+  ::g_source_modify_unix_fd(self.source_, self.tag_,
+                            has_waiters ? G_IO_IN : ::GIOCondition{});
+  // The semaphore may be destroyed by a completion, it is not touched anymore.
+  while (stopped) {
+    event_waiter* waiter = std::exchange(stopped, stopped->next_);
+    waiter->complete_(waiter, true);
+  }
+  while (ready) {
+    event_waiter* waiter = std::exchange(ready, ready->next_);
+    waiter->complete_(waiter, false);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+} // namespace gsenders
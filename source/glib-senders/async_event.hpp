@@ -0,0 +1,398 @@
+#ifndef GLIB_SENDERS_ASYNC_EVENT_HPP
+#define GLIB_SENDERS_ASYNC_EVENT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+#include <stdexec/execution.hpp>
+
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+/// @brief An eventfd whose notifications are coalesced.
+///
+/// Only the first notify() after a reset() writes to the eventfd, all others
+/// return without a system call.
+class eventfd_notifier {
+public:
+  /// @brief Create a non-blocking eventfd.
+  ///
+  /// @throws std::system_error if the eventfd cannot be created
+  eventfd_notifier();
+
+  /// @brief Make the eventfd readable. Thread-safe.
+  auto notify() noexcept -> void;
+
+  /// @brief Drain the eventfd such that it is no longer readable.
+  ///
+  /// Notifications that race with this call are not lost.
+  auto reset() noexcept -> void;
+
+  [[nodiscard]] auto native_handle() const noexcept -> int;
+
+private:
+  safe_file_descriptor fd_;
+  std::atomic<bool> notified_{false};
+};
+
+/// @brief A wait for an async_event or an async_semaphore.
+struct event_waiter {
+  event_waiter* next_{nullptr};
+  void (*complete_)(event_waiter*, bool stopped) noexcept = nullptr;
+  std::atomic<bool> stop_requested_{false};
+};
+
+template <class Primitive> class event_waiter_sender;
+
+/// @brief An event that can be notified from any thread and awaited on the
+/// GLib event loop.
+///
+/// Every sender of wait() that is pending when the event is notified completes
+/// in the same loop iteration. A notification that arrives while nobody waits
+/// is kept until the next waiter consumes it.
+///
+/// All waiters share a single GSource that polls the eventfd while any of them
+/// is pending. The eventfd is drained once per notification.
+class async_event {
+public:
+  explicit async_event(glib_scheduler scheduler);
+
+  /// Pending waiters are dropped without completing.
+  ~async_event();
+
+  async_event(const async_event&) = delete;
+  async_event& operator=(const async_event&) = delete;
+
+  /// @brief Notify the event. Thread-safe.
+  ///
+  /// Concurrent notifications are coalesced into a single wakeup.
+  auto notify() noexcept -> void { notifier_.notify(); }
+
+  /// @brief Get a sender that completes after the next notification.
+  [[nodiscard]] auto wait() noexcept -> event_waiter_sender<async_event>;
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+private:
+  template <class, class> friend class event_waiter_operation;
+
+  auto start(event_waiter* waiter) noexcept -> void;
+  auto request_stop(event_waiter* waiter) noexcept -> void;
+  static auto dispatch(gpointer data) -> gboolean;
+
+  glib_scheduler scheduler_;
+  eventfd_notifier notifier_{};
+  ::GSource* source_{nullptr};
+  gpointer tag_{nullptr};
+  std::mutex mutex_{};
+  event_waiter* head_{nullptr};
+  event_waiter* tail_{nullptr};
+};
+
+/// @brief A counting semaphore that can be released from any thread and
+/// acquired on the GLib event loop.
+///
+/// Acquiring an available unit completes inline. Otherwise the acquirer is
+/// queued, and released units are handed to the queued acquirers in the order
+/// in which they have started. Like async_event, all of them share a single
+/// GSource, and release() only touches the eventfd if somebody waits.
+class async_semaphore {
+public:
+  explicit async_semaphore(glib_scheduler scheduler,
+                           std::size_t initial_count = 0);
+
+  /// Pending acquirers are dropped without completing.
+  ~async_semaphore();
+
+  async_semaphore(const async_semaphore&) = delete;
+  async_semaphore& operator=(const async_semaphore&) = delete;
+
+  /// @brief Add units to the semaphore. Thread-safe.
+  auto release(std::size_t n = 1) noexcept -> void;
+
+  /// @brief Take a unit if one is available and nobody is queued for it.
+  /// Thread-safe.
+  [[nodiscard]] auto try_acquire() noexcept -> bool;
+
+  /// @brief Get a sender that completes once a unit has been taken.
+  [[nodiscard]] auto acquire() noexcept -> event_waiter_sender<async_semaphore>;
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+private:
+  template <class, class> friend class event_waiter_operation;
+
+  auto start(event_waiter* waiter) noexcept -> void;
+  auto request_stop(event_waiter* waiter) noexcept -> void;
+  static auto dispatch(gpointer data) -> gboolean;
+
+  glib_scheduler scheduler_;
+  eventfd_notifier notifier_{};
+  ::GSource* source_{nullptr};
+  gpointer tag_{nullptr};
+  std::mutex mutex_{};
+  std::size_t count_;
+  event_waiter* head_{nullptr};
+  event_waiter* tail_{nullptr};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+/// @brief Waits for a Primitive that queues event_waiters, which is
+/// async_event or async_semaphore.
+template <class Primitive, class Receiver>
+class event_waiter_operation : event_waiter {
+  Primitive& primitive_;
+  [[no_unique_address]] Receiver receiver_;
+
+  struct on_stop_requested {
+    Primitive& primitive_;
+    event_waiter& waiter_;
+    void operator()() noexcept { primitive_.request_stop(&waiter_); }
+  };
+  using on_stop = std::optional<typename stdexec::stop_token_of_t<
+      stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto complete(event_waiter* waiter, bool stopped) noexcept -> void {
+    auto& self = *static_cast<event_waiter_operation*>(waiter);
+    self.on_stop_.reset();
+    if (stopped) {
+      stdexec::set_stopped(std::move(self.receiver_));
+    } else {
+      stdexec::set_value(std::move(self.receiver_));
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t,
+                         event_waiter_operation& self) noexcept -> void {
+    self.on_stop_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
+        on_stop_requested{self.primitive_, self});
+    self.primitive_.start(&self);
+  }
+
+public:
+  event_waiter_operation(Primitive& primitive, Receiver&& receiver)
+      : primitive_{primitive}, receiver_{std::move(receiver)} {
+    this->complete_ = &complete;
+  }
+  event_waiter_operation(event_waiter_operation&&) = delete;
+};
+
+template <class Primitive> class event_waiter_sender {
+public:
+  using completion_signatures =
+      stdexec::completion_signatures<stdexec::set_value_t(),
+                                     stdexec::set_stopped_t()>;
+
+  explicit event_waiter_sender(Primitive& primitive) noexcept
+      : primitive_{&primitive} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  Primitive* primitive_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const event_waiter_sender& self,
+                         R&& receiver)
+      -> event_waiter_operation<Primitive, std::remove_cvref_t<R>> {
+    return {*self.primitive_, std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const event_waiter_sender& self) noexcept {
+    return attrs{self.primitive_->get_scheduler()};
+  }
+};
+
+inline auto async_event::wait() noexcept -> event_waiter_sender<async_event> {
+  return event_waiter_sender<async_event>{*this};
+}
+
+inline auto async_semaphore::acquire() noexcept
+    -> event_waiter_sender<async_semaphore> {
+  return event_waiter_sender<async_semaphore>{*this};
+}
+
+/// @brief Acquires from a Policy, waiting for its eventfd doorbell whenever
+/// nothing can be acquired.
+///
+/// A Policy provides
+///
+///  - value_type, the value to complete with, or void,
+///  - try_acquire(), which returns a bool for void and an optional otherwise,
+///  - set_waiting(bool), which tells the notifying side whether to ring,
+///  - reset_doorbell() and doorbell(), to drain and to get the eventfd, and
+///  - get_scheduler(), the scheduler to wait on.
+///
+/// Every operation polls the eventfd with a GSource of its own, so a doorbell
+/// should only have a single waiter, like an endpoint of a shm_channel.
+template <class Policy, class Receiver> class doorbell_operation {
+  using value_type = typename Policy::value_type;
+  using stored_value = std::conditional_t<std::is_void_v<value_type>,
+                                          std::monostate, value_type>;
+
+  struct wake_receiver {
+    doorbell_operation* op_;
+
+    friend auto tag_invoke(stdexec::set_value_t, wake_receiver&& self,
+                           int) noexcept -> void {
+      self.op_->wake();
+    }
+
+    friend auto tag_invoke(stdexec::set_error_t, wake_receiver&& self,
+                           std::exception_ptr error) noexcept -> void {
+      self.op_->policy_.set_waiting(false);
+      stdexec::set_error(std::move(self.op_->receiver_), std::move(error));
+    }
+
+    friend auto tag_invoke(stdexec::set_stopped_t,
+                           wake_receiver&& self) noexcept -> void {
+      self.op_->policy_.set_waiting(false);
+      stdexec::set_stopped(std::move(self.op_->receiver_));
+    }
+
+    friend auto tag_invoke(stdexec::get_env_t,
+                           const wake_receiver& self) noexcept
+        -> stdexec::env_of_t<Receiver> {
+      return stdexec::get_env(self.op_->receiver_);
+    }
+  };
+  using wait_operation =
+      stdexec::connect_result_t<wait_until_sender, wake_receiver>;
+
+  Policy policy_;
+  [[no_unique_address]] Receiver receiver_;
+  std::optional<stored_value> value_{};
+  std::optional<wait_operation> wait_{};
+
+  auto try_acquire() -> bool {
+    if constexpr (std::is_void_v<value_type>) {
+      return policy_.try_acquire();
+    } else {
+      value_ = policy_.try_acquire();
+      return value_.has_value();
+    }
+  }
+
+  auto arm() noexcept -> void {
+    try {
+      wait_.emplace(emplace_from{[this] {
+        return stdexec::connect(wait_until(policy_.get_scheduler(),
+                                           policy_.doorbell(),
+                                           io_condition::is_readable),
+                                wake_receiver{this});
+      }});
+      stdexec::start(*wait_);
+    } catch (...) {
+      policy_.set_waiting(false);
+      stdexec::set_error(std::move(receiver_), std::current_exception());
+    }
+  }
+
+  auto poll() noexcept -> void {
+    bool waiting = false;
+    try {
+      if (!try_acquire()) {
+        // Announce the waiter before checking again, such that the notifying
+        // side either makes progress visible to us or rings the doorbell.
+        policy_.set_waiting(true);
+        waiting = true;
+        if (!try_acquire()) {
+          arm();
+          return;
+        }
+        policy_.set_waiting(false);
+      }
+    } catch (...) {
+      if (waiting) {
+        policy_.set_waiting(false);
+      }
+      stdexec::set_error(std::move(receiver_), std::current_exception());
+      return;
+    }
+    if constexpr (std::is_void_v<value_type>) {
+      stdexec::set_value(std::move(receiver_));
+    } else {
+      stdexec::set_value(std::move(receiver_), std::move(*value_));
+    }
+  }
+
+  // Destroys and re-creates the wait operation from within its completion,
+  // which does not touch its state after completing the receiver.
+  auto wake() noexcept -> void {
+    policy_.reset_doorbell();
+    policy_.set_waiting(false);
+    poll();
+  }
+
+  friend auto tag_invoke(stdexec::start_t, doorbell_operation& self) noexcept
+      -> void {
+    self.poll();
+  }
+
+public:
+  doorbell_operation(Policy policy, Receiver&& receiver)
+      : policy_{policy}, receiver_{std::move(receiver)} {}
+  doorbell_operation(doorbell_operation&&) = delete;
+};
+
+template <class Policy> class doorbell_sender {
+public:
+  using completion_signatures = stdexec::completion_signatures<
+      value_signature_t<typename Policy::value_type>,
+      stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+  explicit doorbell_sender(Policy policy) noexcept : policy_{policy} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  Policy policy_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const doorbell_sender& self,
+                         R&& receiver)
+      -> doorbell_operation<Policy, std::remove_cvref_t<R>> {
+    return {self.policy_, std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const doorbell_sender& self) noexcept {
+    return attrs{self.policy_.get_scheduler()};
+  }
+};
+
+} // namespace gsenders
+
+#endif
@@ -0,0 +1,442 @@
+#ifndef GLIB_SENDERS_BROADCAST_CHANNEL_HPP
+#define GLIB_SENDERS_BROADCAST_CHANNEL_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <stdexec/execution.hpp>
+
+namespace gsenders {
+
+/// @brief What a broadcast channel does when a subscriber is full.
+enum class broadcast_policy {
+  /// Sending never waits. The oldest payload of a full subscriber is dropped.
+  drop_oldest,
+  /// Sending waits until every subscriber has room for the payload.
+  backpressure
+};
+
+/// @brief A channel that delivers every payload to all of its subscribers.
+///
+/// A payload is allocated once as an immutable, reference-counted object.
+/// Each subscriber receives a shared pointer to it, such that fanning out to N
+/// subscribers costs N reference counts instead of N copies. Only subscribers
+/// that exist when a payload is sent receive it.
+///
+/// Every subscriber buffers up to `capacity` payloads that have not been
+/// received yet. A full subscriber is handled according to the policy of the
+/// channel.
+///
+/// All member functions are thread-safe. Completions run inline on the thread
+/// that sends or receives, like with channel.
+template <class Ty> class broadcast_channel {
+public:
+  using payload_type = std::shared_ptr<const Ty>;
+
+  explicit broadcast_channel(
+      std::size_t capacity = 16,
+      broadcast_policy policy = broadcast_policy::drop_oldest) noexcept
+      : capacity_{std::max<std::size_t>(capacity, 1)}, policy_{policy} {}
+
+  broadcast_channel(const broadcast_channel&) = delete;
+  broadcast_channel& operator=(const broadcast_channel&) = delete;
+
+private:
+  struct waiter {
+    waiter* next_{nullptr};
+    void (*complete_)(waiter*) noexcept = nullptr;
+    payload_type value_{};
+  };
+
+  struct waiter_list {
+    waiter* head_{nullptr};
+    waiter* tail_{nullptr};
+
+    auto push(waiter* op) noexcept -> void {
+      op->next_ = nullptr;
+      if (tail_) {
+        tail_->next_ = op;
+      } else {
+        head_ = op;
+      }
+      tail_ = op;
+    }
+
+    auto pop() noexcept -> waiter* {
+      waiter* op = head_;
+      head_ = op->next_;
+      if (!head_) {
+        tail_ = nullptr;
+      }
+      return op;
+    }
+
+    auto erase(waiter* op) noexcept -> bool {
+      waiter* previous = nullptr;
+      for (waiter* it = head_; it; previous = it, it = it->next_) {
+        if (it == op) {
+          (previous ? previous->next_ : head_) = it->next_;
+          if (tail_ == it) {
+            tail_ = previous;
+          }
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Completes all operations, which may destroy them.
+    auto complete_all() noexcept -> void {
+      while (head_) {
+        waiter* op = pop();
+        op->complete_(op);
+      }
+    }
+  };
+
+  struct subscriber_state {
+    std::deque<payload_type> queue_{};
+    waiter* receive_{nullptr};
+    std::size_t dropped_{0};
+    void (*on_ready_)(void*) noexcept = nullptr;
+    void* on_ready_data_{nullptr};
+  };
+
+  // The following functions require mutex_ to be held. Operations that become
+  // ready are collected in `ready` and completed after unlocking.
+
+  auto has_room() const noexcept -> bool {
+    return policy_ == broadcast_policy::drop_oldest ||
+           std::all_of(subscribers_.begin(), subscribers_.end(),
+                       [this](const subscriber_state* subscriber) {
+                         return subscriber->queue_.size() < capacity_;
+                       });
+  }
+
+  auto publish(const payload_type& value, waiter_list& ready) -> void {
+    for (subscriber_state* subscriber : subscribers_) {
+      if (subscriber->receive_) {
+        waiter* op = std::exchange(subscriber->receive_, nullptr);
+        op->value_ = value;
+        ready.push(op);
+        continue;
+      }
+      if (subscriber->queue_.size() == capacity_) {
+        subscriber->queue_.pop_front();
+        ++subscriber->dropped_;
+      }
+      subscriber->queue_.push_back(value);
+      if (subscriber->on_ready_) {
+        subscriber->on_ready_(subscriber->on_ready_data_);
+      }
+    }
+  }
+
+  auto publish_pending(waiter_list& ready) -> void {
+    while (pending_sends_.head_ && has_room()) {
+      waiter* op = pending_sends_.pop();
+      publish(op->value_, ready);
+      op->value_.reset();
+      ready.push(op);
+    }
+  }
+
+  template <class Receiver> class send_operation : waiter {
+    broadcast_channel& channel_;
+    [[no_unique_address]] Receiver receiver_;
+
+    struct on_stop_requested {
+      send_operation& op_;
+      void operator()() noexcept {
+        bool removed = false;
+        {
+          std::lock_guard lock{op_.channel_.mutex_};
+          removed = op_.channel_.pending_sends_.erase(&op_);
+        }
+        if (removed) {
+          stdexec::set_stopped(std::move(op_.receiver_));
+        }
+      }
+    };
+    using on_stop = std::optional<typename stdexec::stop_token_of_t<
+        stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+    on_stop on_stop_{};
+
+    static auto complete(waiter* op) noexcept -> void {
+      auto& self = *static_cast<send_operation*>(op);
+      self.on_stop_.reset();
+      stdexec::set_value(std::move(self.receiver_));
+    }
+
+    friend auto tag_invoke(stdexec::start_t, send_operation& self) noexcept
+        -> void {
+      broadcast_channel& channel = self.channel_;
+      auto token = stdexec::get_stop_token(stdexec::get_env(self.receiver_));
+      if (channel.policy_ == broadcast_policy::backpressure) {
+        // Registered before enqueueing, such that a stop request cannot race
+        // with a completion that has not unregistered it yet.
+        self.on_stop_.emplace(token, on_stop_requested{self});
+      }
+      waiter_list ready{};
+      bool stopped = false;
+      {
+        std::lock_guard lock{channel.mutex_};
+        if (!channel.pending_sends_.head_ && channel.has_room()) {
+          channel.publish(self.value_, ready);
+          self.value_.reset();
+          ready.push(&self);
+        } else if (token.stop_requested()) {
+          stopped = true;
+        } else {
+          channel.pending_sends_.push(&self);
+        }
+      }
+      ready.complete_all();
+      if (stopped) {
+        self.on_stop_.reset();
+        stdexec::set_stopped(std::move(self.receiver_));
+      }
+    }
+
+  public:
+    send_operation(broadcast_channel& channel, payload_type value,
+                   Receiver&& receiver)
+        : channel_{channel}, receiver_{std::move(receiver)} {
+      this->complete_ = &complete;
+      this->value_ = std::move(value);
+    }
+    send_operation(send_operation&&) = delete;
+  };
+
+  class send_sender {
+  public:
+    using completion_signatures =
+        stdexec::completion_signatures<stdexec::set_value_t(),
+                                       stdexec::set_stopped_t()>;
+
+    send_sender(broadcast_channel& channel, payload_type value) noexcept
+        : channel_{&channel}, value_{std::move(value)} {}
+
+  private:
+    broadcast_channel* channel_;
+    payload_type value_;
+
+    template <stdexec::__decays_to<send_sender> Self, class R>
+    requires stdexec::receiver<R>
+    friend auto tag_invoke(stdexec::connect_t, Self&& self, R&& receiver)
+        -> send_operation<std::remove_cvref_t<R>> {
+      return {*self.channel_, std::forward<Self>(self).value_,
+              std::forward<R>(receiver)};
+    }
+  };
+
+  template <class Receiver> class receive_operation : waiter {
+    broadcast_channel& channel_;
+    subscriber_state& subscriber_;
+    [[no_unique_address]] Receiver receiver_;
+
+    struct on_stop_requested {
+      receive_operation& op_;
+      void operator()() noexcept {
+        bool removed = false;
+        {
+          std::lock_guard lock{op_.channel_.mutex_};
+          if (op_.subscriber_.receive_ == &op_) {
+            op_.subscriber_.receive_ = nullptr;
+            removed = true;
+          }
+        }
+        if (removed) {
+          stdexec::set_stopped(std::move(op_.receiver_));
+        }
+      }
+    };
+    using on_stop = std::optional<typename stdexec::stop_token_of_t<
+        stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+    on_stop on_stop_{};
+
+    static auto complete(waiter* op) noexcept -> void {
+      auto& self = *static_cast<receive_operation*>(op);
+      self.on_stop_.reset();
+      stdexec::set_value(std::move(self.receiver_), std::move(self.value_));
+    }
+
+    friend auto tag_invoke(stdexec::start_t, receive_operation& self) noexcept
+        -> void {
+      broadcast_channel& channel = self.channel_;
+      auto token = stdexec::get_stop_token(stdexec::get_env(self.receiver_));
+      self.on_stop_.emplace(token, on_stop_requested{self});
+      waiter_list ready{};
+      bool stopped = false;
+      {
+        std::lock_guard lock{channel.mutex_};
+        if (!self.subscriber_.queue_.empty()) {
+          self.value_ = std::move(self.subscriber_.queue_.front());
+          self.subscriber_.queue_.pop_front();
+          channel.publish_pending(ready);
+          ready.push(&self);
+        } else if (token.stop_requested()) {
+          stopped = true;
+        } else {
+          self.subscriber_.receive_ = &self;
+        }
+      }
+      ready.complete_all();
+      if (stopped) {
+        self.on_stop_.reset();
+        stdexec::set_stopped(std::move(self.receiver_));
+      }
+    }
+
+  public:
+    receive_operation(broadcast_channel& channel, subscriber_state& subscriber,
+                      Receiver&& receiver)
+        : channel_{channel}, subscriber_{subscriber},
+          receiver_{std::move(receiver)} {
+      this->complete_ = &complete;
+    }
+    receive_operation(receive_operation&&) = delete;
+  };
+
+  class receive_sender {
+  public:
+    using completion_signatures =
+        stdexec::completion_signatures<stdexec::set_value_t(payload_type),
+                                       stdexec::set_stopped_t()>;
+
+    receive_sender(broadcast_channel& channel,
+                   subscriber_state& subscriber) noexcept
+        : channel_{&channel}, subscriber_{&subscriber} {}
+
+  private:
+    broadcast_channel* channel_;
+    subscriber_state* subscriber_;
+
+    template <class R>
+    requires stdexec::receiver<R>
+    friend auto tag_invoke(stdexec::connect_t, const receive_sender& self,
+                           R&& receiver)
+        -> receive_operation<std::remove_cvref_t<R>> {
+      return {*self.channel_, *self.subscriber_, std::forward<R>(receiver)};
+    }
+  };
+
+public:
+  /// @brief A registration with a broadcast channel.
+  ///
+  /// Unsubscribes on destruction. At most one receive() may be pending at a
+  /// time, and none may be pending when the subscription is destroyed.
+  /// A moved-from subscription is empty: it must not receive(), is never
+  /// ready() and has dropped() nothing.
+  class subscription {
+  public:
+    subscription(subscription&&) noexcept = default;
+    subscription& operator=(subscription&&) = delete;
+
+    ~subscription() {
+      if (state_) {
+        channel_->unsubscribe(*state_);
+      }
+    }
+
+    /// @brief Get a sender that completes with the next payload.
+    [[nodiscard]] auto receive() noexcept -> receive_sender {
+      assert(state_ && "receive() on a moved-from subscription");
+      return receive_sender{*channel_, *state_};
+    }
+
+    /// @brief Get the number of payloads that have been dropped because this
+    /// subscriber was full.
+    [[nodiscard]] auto dropped() const -> std::size_t {
+      if (!state_) {
+        return 0;
+      }
+      std::lock_guard lock{channel_->mutex_};
+      return state_->dropped_;
+    }
+
+    /// @brief True if a payload can be received without waiting.
+    [[nodiscard]] auto ready() const -> bool {
+      if (!state_) {
+        return false;
+      }
+      std::lock_guard lock{channel_->mutex_};
+      return !state_->queue_.empty();
+    }
+
+    /// @brief Install a function that is called whenever a payload is
+    /// buffered for this subscriber, or remove it with nullptr.
+    ///
+    /// The function is called with the lock of the channel held, from the
+    /// sending thread. It must not call back into the channel.
+    auto notify_on_ready(void (*on_ready)(void*) noexcept, void* data) -> void {
+      if (!state_) {
+        return;
+      }
+      std::lock_guard lock{channel_->mutex_};
+      state_->on_ready_ = on_ready;
+      state_->on_ready_data_ = data;
+    }
+
+  private:
+    friend class broadcast_channel;
+
+    subscription(broadcast_channel& channel,
+                 std::unique_ptr<subscriber_state> state) noexcept
+        : channel_{&channel}, state_{std::move(state)} {}
+
+    broadcast_channel* channel_;
+    std::unique_ptr<subscriber_state> state_;
+  };
+
+  /// @brief Register a new subscriber for all payloads sent from now on.
+  [[nodiscard]] auto subscribe() -> subscription {
+    auto state = std::make_unique<subscriber_state>();
+    std::lock_guard lock{mutex_};
+    subscribers_.push_back(state.get());
+    return subscription{*this, std::move(state)};
+  }
+
+  /// @brief Get a sender that publishes a payload to all subscribers.
+  ///
+  /// With broadcast_policy::backpressure it completes once every subscriber
+  /// has room for the payload. Payloads are published in the order in which
+  /// their senders are started.
+  [[nodiscard]] auto send(payload_type value) noexcept -> send_sender {
+    return send_sender{*this, std::move(value)};
+  }
+
+  /// @brief Allocate a payload from a value and publish it.
+  [[nodiscard]] auto send(Ty value) -> send_sender {
+    return send_sender{*this, std::make_shared<const Ty>(std::move(value))};
+  }
+
+private:
+  auto unsubscribe(subscriber_state& state) noexcept -> void {
+    waiter_list ready{};
+    {
+      std::lock_guard lock{mutex_};
+      std::erase(subscribers_, &state);
+      publish_pending(ready);
+    }
+    ready.complete_all();
+  }
+
+  std::size_t capacity_;
+  broadcast_policy policy_;
+  mutable std::mutex mutex_{};
+  std::vector<subscriber_state*> subscribers_{};
+  waiter_list pending_sends_{};
+};
+
+} // namespace gsenders
+
+#endif
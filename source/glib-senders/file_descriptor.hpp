@@ -1,6 +1,7 @@
 #ifndef DOKO_SAFE_FILE_DESCRIPTOR_HPP
 #define DOKO_SAFE_FILE_DESCRIPTOR_HPP
 
+#include <chrono>
 #include <span>
 #include <system_error>
 #include <utility>
@@ -21,6 +22,19 @@ struct async_write_some_t {
     return tag_invoke(async_write_some_t{}, std::forward<Object>(io), buffer);
   }
 
+  template <class Object>
+  requires stdexec::tag_invocable<async_write_some_t, Object,
+                                  std::span<const char>,
+                                  std::chrono::system_clock::duration>
+  auto operator()(Object&& io, std::span<const char> buffer,
+                  std::chrono::system_clock::duration timeout) const
+      noexcept(stdexec::nothrow_tag_invocable<
+               async_write_some_t, Object, std::span<const char>,
+               std::chrono::system_clock::duration>) {
+    return tag_invoke(async_write_some_t{}, std::forward<Object>(io), buffer,
+                      timeout);
+  }
+
   template <class S>
   requires stdexec::sender<S>
   auto operator()(S&& sender, std::span<const char> buffer) const noexcept(
@@ -61,6 +75,18 @@ struct async_read_some_t {
     return tag_invoke(async_read_some_t{}, std::forward<Object>(io), buffer);
   }
 
+  template <class Object>
+  requires stdexec::tag_invocable<async_read_some_t, Object, std::span<char>,
+                                  std::chrono::system_clock::duration>
+  auto operator()(Object&& io, std::span<char> buffer,
+                  std::chrono::system_clock::duration timeout) const
+      noexcept(stdexec::nothrow_tag_invocable<
+               async_read_some_t, Object, std::span<char>,
+               std::chrono::system_clock::duration>) {
+    return tag_invoke(async_read_some_t{}, std::forward<Object>(io), buffer,
+                      timeout);
+  }
+
   template <class S>
   requires stdexec::sender<S>
   auto operator()(S&& sender, std::span<char> buffer) const noexcept(
@@ -112,28 +138,57 @@ public:
 
   [[nodiscard]] auto get_handle() const noexcept -> int { return fd_; }
 
+private:
+  static auto read_some(std::span<char> buffer) {
+    return [buffer](int fd) {
+      ssize_t nbytes = ::read(fd, buffer.data(), buffer.size());
+      if (nbytes == -1) {
+        throw std::system_error(errno, std::system_category());
+      }
+      return buffer.subspan(0, nbytes);
+    };
+  }
+
+  static auto write_some(std::span<const char> buffer) {
+    return [buffer](int fd) {
+      ssize_t nbytes = ::write(fd, buffer.data(), buffer.size());
+      if (nbytes == -1) {
+        throw std::system_error(errno, std::system_category());
+      }
+      return buffer.subspan(nbytes);
+    };
+  }
+
   friend auto tag_invoke(async_read_some_t, basic_file_descriptor fd,
                          std::span<char> buffer) {
     return wait_until(fd.scheduler_, fd.fd_, io_condition::is_readable) |
-           stdexec::then([buffer](int fd) {
-             ssize_t nbytes = ::read(fd, buffer.data(), buffer.size());
-             if (nbytes == -1) {
-               throw std::system_error(errno, std::system_category());
-             }
-             return buffer.subspan(0, nbytes);
-           });
+           stdexec::then(read_some(buffer));
+  }
+
+  /// Completes with an std::system_error of std::errc::timed_out if the file
+  /// descriptor does not become readable within the given timeout.
+  friend auto tag_invoke(async_read_some_t, basic_file_descriptor fd,
+                         std::span<char> buffer,
+                         std::chrono::system_clock::duration timeout) {
+    return wait_until(fd.scheduler_, fd.fd_, io_condition::is_readable,
+                      timeout) |
+           stdexec::then(read_some(buffer));
   }
 
   friend auto tag_invoke(async_write_some_t, basic_file_descriptor fd,
                          std::span<const char> buffer) {
     return wait_until(fd.scheduler_, fd.fd_, io_condition::is_writeable) |
-           stdexec::then([buffer](int fd) {
-             ssize_t nbytes = ::write(fd, buffer.data(), buffer.size());
-             if (nbytes == -1) {
-               throw std::system_error(errno, std::system_category());
-             }
-             return buffer.subspan(nbytes);
-           });
+           stdexec::then(write_some(buffer));
+  }
+
+  /// Completes with an std::system_error of std::errc::timed_out if the file
+  /// descriptor does not become writeable within the given timeout.
+  friend auto tag_invoke(async_write_some_t, basic_file_descriptor fd,
+                         std::span<const char> buffer,
+                         std::chrono::system_clock::duration timeout) {
+    return wait_until(fd.scheduler_, fd.fd_, io_condition::is_writeable,
+                      timeout) |
+           stdexec::then(write_some(buffer));
   }
 };
 
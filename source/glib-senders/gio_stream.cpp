@@ -0,0 +1,193 @@
+#include "glib-senders/gio_stream.hpp"
+
+#include <cassert>
+#include <string>
+
+namespace gsenders {
+
+namespace {
+class gio_category_impl : public std::error_category {
+public:
+  auto name() const noexcept -> const char* override { return "gio"; }
+
+  auto message(int code) const -> std::string override {
+    switch (static_cast<::GIOErrorEnum>(code)) {
+    case G_IO_ERROR_FAILED:
+      return "Operation failed";
+    case G_IO_ERROR_NOT_FOUND:
+      return "Not found";
+    case G_IO_ERROR_EXISTS:
+      return "Already exists";
+    case G_IO_ERROR_PERMISSION_DENIED:
+      return "Permission denied";
+    case G_IO_ERROR_NOT_SUPPORTED:
+      return "Operation not supported";
+    case G_IO_ERROR_CLOSED:
+      return "Stream is closed";
+    case G_IO_ERROR_CANCELLED:
+      return "Operation was cancelled";
+    case G_IO_ERROR_PENDING:
+      return "Operation is pending";
+    case G_IO_ERROR_TIMED_OUT:
+      return "Operation timed out";
+    case G_IO_ERROR_WOULD_BLOCK:
+      return "Operation would block";
+    case G_IO_ERROR_CONNECTION_REFUSED:
+      return "Connection refused";
+    case G_IO_ERROR_BROKEN_PIPE:
+      return "Broken pipe";
+    default:
+      return "GIO error " + std::to_string(code);
+    }
+  }
+};
+
+// Pushes a context as thread-default, such that GIO dispatches the callbacks
+// of asynchronous calls on it. The calling thread must own the context.
+class thread_default_context {
+public:
+  explicit thread_default_context(::GMainContext* context) noexcept
+      : context_{context} {
+    ::g_main_context_push_thread_default(context_);
+  }
+  ~thread_default_context() { ::g_main_context_pop_thread_default(context_); }
+
+  thread_default_context(const thread_default_context&) = delete;
+  thread_default_context& operator=(const thread_default_context&) = delete;
+
+private:
+  ::GMainContext* context_;
+};
+} // namespace
+
+auto gio_category() noexcept -> const std::error_category& {
+  static gio_category_impl category{};
+  return category;
+}
+
+gio_operation_base::gio_operation_base(glib_scheduler scheduler,
+                                       gio_request request,
+                                       complete_fn complete) noexcept
+    : context_{scheduler.get_GMainContext()}, request_{request},
+      complete_{complete} {
+  ::g_object_ref(request_.stream_);
+  if (request_.bytes_) {
+    ::g_bytes_ref(request_.bytes_);
+  }
+}
+
+gio_operation_base::~gio_operation_base() {
+  if (result_bytes_) {
+    ::g_bytes_unref(result_bytes_);
+  }
+  if (request_.bytes_) {
+    ::g_bytes_unref(request_.bytes_);
+  }
+  ::g_object_unref(request_.stream_);
+  ::g_clear_error(&error_);
+  ::g_clear_object(&cancellable_);
+}
+
+auto gio_operation_base::request_stop() noexcept -> void {
+  ::g_cancellable_cancel(cancellable_);
+}
+
+auto gio_operation_base::make_cancellable() noexcept -> void {
+  cancellable_ = ::g_cancellable_new();
+}
+
+auto gio_operation_base::start_request() noexcept -> void {
+  if (::g_main_context_is_owner(context_)) {
+    issue_request();
+    return;
+  }
+  ::GSource* source = make_ready_time_source(&on_loop, this);
+  ::g_source_set_ready_time(source, 0);
+  ::g_source_attach(source, context_);
+  ::g_source_unref(source);
+}
+
+auto gio_operation_base::on_loop(gpointer data) -> gboolean {
+  static_cast<gio_operation_base*>(data)->issue_request();
+  return G_SOURCE_REMOVE;
+}
+
+auto gio_operation_base::issue_request() noexcept -> void {
+  assert(::g_main_context_is_owner(context_));
+  thread_default_context guard{context_};
+  switch (request_.kind_) {
+  case gio_request::kind::read_bytes:
+    ::g_input_stream_read_bytes_async(
+        static_cast<::GInputStream*>(request_.stream_), request_.count_,
+        G_PRIORITY_DEFAULT, cancellable_, &on_ready, this);
+    break;
+  case gio_request::kind::write_bytes:
+    ::g_output_stream_write_bytes_async(
+        static_cast<::GOutputStream*>(request_.stream_), request_.bytes_,
+        G_PRIORITY_DEFAULT, cancellable_, &on_ready, this);
+    break;
+  case gio_request::kind::close_input:
+    ::g_input_stream_close_async(static_cast<::GInputStream*>(request_.stream_),
+                                 G_PRIORITY_DEFAULT, cancellable_, &on_ready,
+                                 this);
+    break;
+  case gio_request::kind::close_output:
+    ::g_output_stream_close_async(
+        static_cast<::GOutputStream*>(request_.stream_), G_PRIORITY_DEFAULT,
+        cancellable_, &on_ready, this);
+    break;
+  case gio_request::kind::close_stream:
+    ::g_io_stream_close_async(static_cast<::GIOStream*>(request_.stream_),
+                              G_PRIORITY_DEFAULT, cancellable_, &on_ready,
+                              this);
+    break;
+  }
+}
+
+auto gio_operation_base::on_ready(::GObject* object, ::GAsyncResult* result,
+                                  gpointer data) -> void {
+  auto& self = *static_cast<gio_operation_base*>(data);
+  switch (self.request_.kind_) {
+  case gio_request::kind::read_bytes:
+    self.result_bytes_ = ::g_input_stream_read_bytes_finish(
+        G_INPUT_STREAM(object), result, &self.error_);
+    break;
+  case gio_request::kind::write_bytes: {
+    gssize nbytes = ::g_output_stream_write_bytes_finish(
+        G_OUTPUT_STREAM(object), result, &self.error_);
+    self.result_size_ = nbytes > 0 ? static_cast<std::size_t>(nbytes) : 0;
+    break;
+  }
+  case gio_request::kind::close_input:
+    ::g_input_stream_close_finish(G_INPUT_STREAM(object), result,
+                                  &self.error_);
+    break;
+  case gio_request::kind::close_output:
+    ::g_output_stream_close_finish(G_OUTPUT_STREAM(object), result,
+                                   &self.error_);
+    break;
+  case gio_request::kind::close_stream:
+    ::g_io_stream_close_finish(G_IO_STREAM(object), result, &self.error_);
+    break;
+  }
+  self.complete_(&self);
+}
+
+auto gio_operation_base::is_cancelled() const noexcept -> bool {
+  return ::g_error_matches(error_, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+}
+
+auto gio_operation_base::get_error() const -> std::exception_ptr {
+  if (!error_) {
+    return nullptr;
+  }
+  std::string what = ::g_quark_to_string(error_->domain);
+  what += ": ";
+  what += error_->message;
+  // Codes of other domains, e.g. G_RESOLVER_ERROR, would collide with
+  // GIOErrorEnum values.
+  int code = error_->domain == G_IO_ERROR ? error_->code : G_IO_ERROR_FAILED;
+  return std::make_exception_ptr(std::system_error(code, gio_category(), what));
+}
+
+} // namespace gsenders
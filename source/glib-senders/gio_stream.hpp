@@ -0,0 +1,402 @@
+#ifndef GLIB_SENDERS_GIO_STREAM_HPP
+#define GLIB_SENDERS_GIO_STREAM_HPP
+
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <stdexec/execution.hpp>
+
+#include "gio/gio.h"
+
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+struct async_read_bytes_t {
+  template <class Stream, class... Args>
+  requires stdexec::tag_invocable<async_read_bytes_t, Stream, Args...>
+  auto operator()(Stream&& stream, Args&&... args) const noexcept(
+      stdexec::nothrow_tag_invocable<async_read_bytes_t, Stream, Args...>) {
+    return tag_invoke(async_read_bytes_t{}, std::forward<Stream>(stream),
+                      std::forward<Args>(args)...);
+  }
+};
+
+struct async_write_bytes_t {
+  template <class Stream, class... Args>
+  requires stdexec::tag_invocable<async_write_bytes_t, Stream, Args...>
+  auto operator()(Stream&& stream, Args&&... args) const noexcept(
+      stdexec::nothrow_tag_invocable<async_write_bytes_t, Stream, Args...>) {
+    return tag_invoke(async_write_bytes_t{}, std::forward<Stream>(stream),
+                      std::forward<Args>(args)...);
+  }
+};
+
+struct async_close_t {
+  template <class Stream>
+  requires stdexec::tag_invocable<async_close_t, Stream>
+  auto operator()(Stream&& stream) const
+      noexcept(stdexec::nothrow_tag_invocable<async_close_t, Stream>) {
+    return tag_invoke(async_close_t{}, std::forward<Stream>(stream));
+  }
+};
+
+inline constexpr async_read_bytes_t async_read_bytes;
+inline constexpr async_write_bytes_t async_write_bytes;
+inline constexpr async_close_t async_close;
+
+/// @brief The error category of GIOErrorEnum codes.
+///
+/// Errors of the G_IO_ERROR domain keep their code, errors of all other
+/// domains are reported as G_IO_ERROR_FAILED. The message of a
+/// std::system_error from this category contains the domain and the message of
+/// the original GError.
+auto gio_category() noexcept -> const std::error_category&;
+
+/// @brief A shared, immutable GBytes buffer.
+class bytes {
+public:
+  bytes() noexcept = default;
+
+  /// @brief Take ownership of a reference.
+  explicit bytes(::GBytes* handle) noexcept : handle_{handle} {}
+
+  /// @brief Copy a buffer into a new GBytes.
+  [[nodiscard]] static auto copy(std::span<const char> buffer) -> bytes {
+    return bytes{::g_bytes_new(buffer.data(), buffer.size())};
+  }
+
+  bytes(const bytes& other) noexcept
+      : handle_{other.handle_ ? ::g_bytes_ref(other.handle_) : nullptr} {}
+  bytes(bytes&& other) noexcept
+      : handle_{std::exchange(other.handle_, nullptr)} {}
+  bytes& operator=(bytes other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+  ~bytes() {
+    if (handle_) {
+      ::g_bytes_unref(handle_);
+    }
+  }
+
+  [[nodiscard]] auto data() const noexcept -> std::span<const char> {
+    if (!handle_) {
+      return {};
+    }
+    gsize size = 0;
+    auto data = static_cast<const char*>(::g_bytes_get_data(handle_, &size));
+    return {data, size};
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return handle_ ? ::g_bytes_get_size(handle_) : 0;
+  }
+
+  [[nodiscard]] auto empty() const noexcept -> bool { return size() == 0; }
+
+  [[nodiscard]] auto native_handle() const noexcept -> ::GBytes* {
+    return handle_;
+  }
+
+private:
+  ::GBytes* handle_{nullptr};
+};
+
+/// @brief A shared reference to a GObject.
+class object_ref {
+public:
+  object_ref() noexcept = default;
+
+  /// @brief Take a new reference to the object.
+  explicit object_ref(gpointer object) noexcept
+      : object_{object ? ::g_object_ref(object) : nullptr} {}
+
+  object_ref(const object_ref& other) noexcept : object_ref{other.object_} {}
+  object_ref(object_ref&& other) noexcept
+      : object_{std::exchange(other.object_, nullptr)} {}
+  object_ref& operator=(object_ref other) noexcept {
+    std::swap(object_, other.object_);
+    return *this;
+  }
+  ~object_ref() {
+    if (object_) {
+      ::g_object_unref(object_);
+    }
+  }
+
+  [[nodiscard]] auto get() const noexcept -> gpointer { return object_; }
+
+private:
+  gpointer object_{nullptr};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+/// @brief An asynchronous GIO call and its arguments.
+struct gio_request {
+  enum class kind {
+    read_bytes,
+    write_bytes,
+    close_input,
+    close_output,
+    close_stream
+  };
+  kind kind_;
+  gpointer stream_;
+  std::size_t count_{};
+  ::GBytes* bytes_{nullptr};
+};
+
+/// @brief The receiver-independent part of a GIO operation.
+///
+/// The call is issued with the context of the scheduler pushed as the
+/// thread-default context, such that GIO completes it on that context. Pushing
+/// requires to own the context, so an operation that is started on any other
+/// thread first hops onto the loop of the scheduler. Stop requests cancel a
+/// GCancellable, which is only created if the receiver can be stopped at all.
+class gio_operation_base {
+public:
+  gio_operation_base(const gio_operation_base&) = delete;
+  gio_operation_base& operator=(const gio_operation_base&) = delete;
+
+  /// @brief Cancel the call. Thread-safe.
+  auto request_stop() noexcept -> void;
+
+protected:
+  using complete_fn = void (*)(gio_operation_base*) noexcept;
+
+  /// Keeps references to the stream and the bytes of the request.
+  gio_operation_base(glib_scheduler scheduler, gio_request request,
+                     complete_fn complete) noexcept;
+  ~gio_operation_base();
+
+  auto make_cancellable() noexcept -> void;
+  auto start_request() noexcept -> void;
+
+  /// @brief True if the call failed because it has been cancelled.
+  [[nodiscard]] auto is_cancelled() const noexcept -> bool;
+
+  /// @brief Get the error of the call, or nullptr if it succeeded.
+  [[nodiscard]] auto get_error() const -> std::exception_ptr;
+
+  [[nodiscard]] auto take_bytes() noexcept -> bytes {
+    return bytes{std::exchange(result_bytes_, nullptr)};
+  }
+
+  [[nodiscard]] auto get_size() const noexcept -> std::size_t {
+    return result_size_;
+  }
+
+private:
+  /// Issues the call on the thread that owns the context.
+  auto issue_request() noexcept -> void;
+
+  static auto on_loop(gpointer data) -> gboolean;
+  static auto on_ready(::GObject* object, ::GAsyncResult* result,
+                       gpointer data) -> void;
+
+  ::GMainContext* context_;
+  gio_request request_;
+  complete_fn complete_;
+  ::GCancellable* cancellable_{nullptr};
+  ::GError* error_{nullptr};
+  ::GBytes* result_bytes_{nullptr};
+  std::size_t result_size_{};
+};
+
+template <class Receiver, class Value>
+class gio_operation : gio_operation_base {
+  [[no_unique_address]] Receiver receiver_;
+
+  struct on_stop_requested {
+    gio_operation_base& op_;
+    void operator()() noexcept { op_.request_stop(); }
+  };
+  using stop_token = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>&>;
+  using on_stop = std::optional<
+      typename stop_token::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto complete(gio_operation_base* base) noexcept -> void {
+    auto& self = *static_cast<gio_operation*>(base);
+    self.on_stop_.reset();
+    try {
+      if (self.is_cancelled()) {
+        stdexec::set_stopped(std::move(self.receiver_));
+      } else if (std::exception_ptr error = self.get_error()) {
+        stdexec::set_error(std::move(self.receiver_), std::move(error));
+      } else if constexpr (std::is_same_v<Value, bytes>) {
+        stdexec::set_value(std::move(self.receiver_), self.take_bytes());
+      } else if constexpr (std::is_same_v<Value, std::size_t>) {
+        stdexec::set_value(std::move(self.receiver_), self.get_size());
+      } else {
+        stdexec::set_value(std::move(self.receiver_));
+      }
+    } catch (...) {
+      stdexec::set_error(std::move(self.receiver_), std::current_exception());
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t, gio_operation& self) noexcept
+      -> void {
+    stop_token token = stdexec::get_stop_token(stdexec::get_env(self.receiver_));
+    if (token.stop_possible()) {
+      self.make_cancellable();
+      self.on_stop_.emplace(token, on_stop_requested{self});
+    }
+    self.start_request();
+  }
+
+public:
+  gio_operation(glib_scheduler scheduler, gio_request request,
+                Receiver&& receiver)
+      : gio_operation_base{scheduler, request, &complete},
+        receiver_{std::move(receiver)} {}
+  gio_operation(gio_operation&&) = delete;
+};
+
+/// @brief Completes with a Value, or void for close operations.
+template <class Value> class gio_sender {
+public:
+  using completion_signatures = stdexec::completion_signatures<
+      value_signature_t<Value>,
+      stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+  gio_sender(glib_scheduler scheduler, gio_request::kind kind,
+             object_ref stream, std::size_t count = 0,
+             bytes data = {}) noexcept
+      : scheduler_{scheduler}, kind_{kind}, stream_{std::move(stream)},
+        count_{count}, bytes_{std::move(data)} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  glib_scheduler scheduler_;
+  gio_request::kind kind_;
+  object_ref stream_;
+  std::size_t count_;
+  bytes bytes_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const gio_sender& self,
+                         R&& receiver)
+      -> gio_operation<std::remove_cvref_t<R>, Value> {
+    return {self.scheduler_,
+            gio_request{self.kind_, self.stream_.get(), self.count_,
+                        self.bytes_.native_handle()},
+            std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t, const gio_sender& self) noexcept {
+    return attrs{self.scheduler_};
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Streams
+
+/// @brief A GInputStream whose asynchronous calls complete on a scheduler.
+class input_stream {
+public:
+  /// @brief Take a new reference to the stream.
+  input_stream(glib_scheduler scheduler, ::GInputStream* stream) noexcept
+      : scheduler_{scheduler}, stream_{stream} {}
+
+  [[nodiscard]] auto native_handle() const noexcept -> ::GInputStream* {
+    return static_cast<::GInputStream*>(stream_.get());
+  }
+
+private:
+  glib_scheduler scheduler_;
+  object_ref stream_;
+
+  /// Completes with up to `count` bytes, which are empty at the end of the
+  /// stream. The data is not copied.
+  friend auto tag_invoke(async_read_bytes_t, const input_stream& self,
+                         std::size_t count) noexcept -> gio_sender<bytes> {
+    return {self.scheduler_, gio_request::kind::read_bytes, self.stream_,
+            count};
+  }
+
+  friend auto tag_invoke(async_close_t, const input_stream& self) noexcept
+      -> gio_sender<void> {
+    return {self.scheduler_, gio_request::kind::close_input, self.stream_};
+  }
+};
+
+/// @brief A GOutputStream whose asynchronous calls complete on a scheduler.
+class output_stream {
+public:
+  /// @brief Take a new reference to the stream.
+  output_stream(glib_scheduler scheduler, ::GOutputStream* stream) noexcept
+      : scheduler_{scheduler}, stream_{stream} {}
+
+  [[nodiscard]] auto native_handle() const noexcept -> ::GOutputStream* {
+    return static_cast<::GOutputStream*>(stream_.get());
+  }
+
+private:
+  glib_scheduler scheduler_;
+  object_ref stream_;
+
+  /// Completes with the number of bytes that have been written. The sender
+  /// keeps a reference to the bytes until it is destroyed.
+  friend auto tag_invoke(async_write_bytes_t, const output_stream& self,
+                         bytes data) noexcept -> gio_sender<std::size_t> {
+    return {self.scheduler_, gio_request::kind::write_bytes, self.stream_, 0,
+            std::move(data)};
+  }
+
+  friend auto tag_invoke(async_close_t, const output_stream& self) noexcept
+      -> gio_sender<void> {
+    return {self.scheduler_, gio_request::kind::close_output, self.stream_};
+  }
+};
+
+/// @brief A GIOStream, such as a GSocketConnection or a GTlsConnection.
+class io_stream {
+public:
+  /// @brief Take a new reference to the stream.
+  io_stream(glib_scheduler scheduler, ::GIOStream* stream) noexcept
+      : scheduler_{scheduler}, stream_{stream} {}
+
+  [[nodiscard]] auto input() const noexcept -> input_stream {
+    return {scheduler_, ::g_io_stream_get_input_stream(native_handle())};
+  }
+
+  [[nodiscard]] auto output() const noexcept -> output_stream {
+    return {scheduler_, ::g_io_stream_get_output_stream(native_handle())};
+  }
+
+  [[nodiscard]] auto native_handle() const noexcept -> ::GIOStream* {
+    return static_cast<::GIOStream*>(stream_.get());
+  }
+
+private:
+  glib_scheduler scheduler_;
+  object_ref stream_;
+
+  friend auto tag_invoke(async_close_t, const io_stream& self) noexcept
+      -> gio_sender<void> {
+    return {self.scheduler_, gio_request::kind::close_stream, self.stream_};
+  }
+};
+
+} // namespace gsenders
+
+#endif
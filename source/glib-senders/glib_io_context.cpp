@@ -1,6 +1,8 @@
 #include "glib-senders/glib_io_context.hpp"
 
+#include <mutex>
 #include <stdexcept>
+#include <utility>
 
 namespace gsenders {
 
@@ -11,6 +13,504 @@ auto operator&(io_condition c1, io_condition c2) noexcept -> bool {
   return bool(static_cast<int>(c1) & static_cast<int>(c2));
 }
 
+namespace {
+// Bounds the number of operations that run inline after a single dispatch.
+constexpr int max_inline_operations = 64;
+
+struct dispatch_frame {
+  ::GMainContext* context_;
+  dispatch_frame* previous_;
+  inline_operation* head_{nullptr};
+  inline_operation* tail_{nullptr};
+  // The pending counter of the context, known once an operation is queued.
+  std::atomic<std::size_t>* pending_{nullptr};
+};
+
+thread_local dispatch_frame* current_frame = nullptr;
+
+struct overflow_source : ::GSource {
+  inline_operation* head_;
+  inline_operation* tail_;
+  std::atomic<std::size_t>* pending_;
+};
+
+auto drain(dispatch_frame& frame) noexcept -> void;
+
+::GSourceFuncs overflow_vtable{
+    [](::GSource*, int* timeout) -> gboolean {
+      if (timeout) {
+        *timeout = -1;
+      }
+      return true;
+    },       // prepare
+    nullptr, // check
+    [](::GSource* source, ::GSourceFunc, gpointer) -> gboolean {
+      auto& self = *static_cast<overflow_source*>(source);
+      dispatch_frame frame{::g_source_get_context(source), current_frame,
+                           self.head_, self.tail_, self.pending_};
+      self.pending_->fetch_sub(1);
+      current_frame = &frame;
+      drain(frame);
+      current_frame = frame.previous_;
+      return G_SOURCE_REMOVE;
+    },       // dispatch
+    nullptr, // finalize
+    nullptr,
+    nullptr};
+
+auto drain(dispatch_frame& frame) noexcept -> void {
+  for (int n = 0; frame.head_ && n < max_inline_operations; ++n) {
+    inline_operation* op = frame.head_;
+    frame.head_ = op->next_;
+    if (!frame.head_) {
+      frame.tail_ = nullptr;
+    }
+    op->next_ = nullptr;
+    op->execute_(op);
+  }
+  if (frame.head_) {
+    auto source = static_cast<overflow_source*>(
+        ::g_source_new(&overflow_vtable, sizeof(overflow_source)));
+    source->head_ = std::exchange(frame.head_, nullptr);
+    source->tail_ = std::exchange(frame.tail_, nullptr);
+    source->pending_ = frame.pending_;
+    frame.pending_->fetch_add(1);
+    ::g_source_attach(source, frame.context_);
+    ::g_source_unref(source);
+  }
+}
+} // namespace
+
+auto try_schedule_inline(::GMainContext* context,
+                         std::atomic<std::size_t>& pending,
+                         inline_operation* op) noexcept -> bool {
+  dispatch_frame* frame = current_frame;
+  if (!frame || frame->context_ != context || pending.load() > 0) {
+    return false;
+  }
+  frame->pending_ = &pending;
+  if (frame->tail_) {
+    frame->tail_->next_ = op;
+  } else {
+    frame->head_ = op;
+  }
+  frame->tail_ = op;
+  return true;
+}
+
+auto dispatch_and_drain(::GSource* source, ::GSourceFunc callback,
+                        gpointer data) noexcept -> gboolean {
+  dispatch_frame frame{::g_source_get_context(source), current_frame};
+  current_frame = &frame;
+  gboolean result = callback ? callback(data) : G_SOURCE_REMOVE;
+  drain(frame);
+  current_frame = frame.previous_;
+  return result;
+}
+
+namespace {
+::GSourceFuncs schedule_vtable{
+    [](::GSource*, int* timeout) -> gboolean {
+      if (timeout) {
+        *timeout = -1;
+      }
+      return true;
+    },       // prepare
+    nullptr, // check
+    &dispatch_and_drain,
+    nullptr, // finalize
+    nullptr,
+    nullptr};
+
+::GSourceFuncs ready_time_vtable{nullptr, // prepare
+                                 nullptr, // check
+                                 &dispatch_and_drain,
+                                 nullptr, // finalize
+                                 nullptr,
+                                 nullptr};
+} // namespace
+
+auto make_ready_time_source(::GSourceFunc callback, gpointer data) noexcept
+    -> ::GSource* {
+  ::GSource* source = ::g_source_new(&ready_time_vtable, sizeof(::GSource));
+  ::g_source_set_callback(source, callback, data, nullptr);
+  return source;
+}
+
+auto make_source_ready(::GSource* source) noexcept -> void {
+  ::g_source_set_ready_time(source, 0);
+}
+
+auto get_g_io_condition(io_condition condition) noexcept -> ::GIOCondition {
+  ::GIOCondition g_condition{};
+  if (condition & io_condition::is_readable) {
+    g_condition = (GIOCondition)(g_condition | G_IO_IN | G_IO_ERR | G_IO_HUP);
+  }
+  if (condition & io_condition::is_writeable) {
+    g_condition = (GIOCondition)(g_condition | G_IO_OUT | G_IO_ERR | G_IO_HUP);
+  }
+  return g_condition;
+}
+
+schedule_operation_base::schedule_operation_base(glib_io_context& context,
+                                                 complete_fn complete) noexcept
+    : context_{context.context_.get()}, pending_{&context.pending_schedules_},
+      complete_{complete} {
+  this->execute_ = &execute;
+}
+
+auto schedule_operation_base::request_stop() noexcept -> void {
+  stop_requested_.store(true);
+  ::g_main_context_wakeup(context_);
+}
+
+auto schedule_operation_base::try_start_inline() noexcept -> bool {
+  trace_point(trace_operation::schedule, trace_event_kind::start, this);
+  return try_schedule_inline(context_, *pending_, this);
+}
+
+auto schedule_operation_base::start_source() noexcept -> void {
+  pending_->fetch_add(1);
+  ::GSource* source = ::g_source_new(&schedule_vtable, sizeof(::GSource));
+  ::g_source_set_callback(source, &dispatch, this, nullptr);
+  ::g_source_attach(source, context_);
+  ::g_source_unref(source);
+}
+
+auto schedule_operation_base::execute(inline_operation* op) noexcept -> void {
+  auto& self = *static_cast<schedule_operation_base*>(op);
+  trace_point(trace_operation::schedule, trace_event_kind::dispatch_begin,
+              &self);
+  self.complete_(&self, false);
+  trace_point(trace_operation::schedule, trace_event_kind::dispatch_end,
+              &self);
+}
+
+auto schedule_operation_base::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<schedule_operation_base*>(data);
+  trace_point(trace_operation::schedule, trace_event_kind::dispatch_begin,
+              data);
+  self.pending_->fetch_sub(1);
+  self.complete_(&self, self.stop_requested_.load());
+  trace_point(trace_operation::schedule, trace_event_kind::dispatch_end, data);
+  return G_SOURCE_REMOVE;
+}
+
+wait_for_operation_base::wait_for_operation_base(
+    ::GMainContext* context, std::chrono::milliseconds timeout,
+    std::chrono::milliseconds slack, complete_fn complete) noexcept
+    : context_{context}, timeout_{timeout}, slack_{slack}, complete_{complete} {
+}
+
+auto wait_for_operation_base::request_stop() noexcept -> void {
+  stop_requested_.store(true);
+  make_source_ready(source_);
+}
+
+auto wait_for_operation_base::get_ready_time() const noexcept -> ::gint64 {
+  using std::chrono::microseconds;
+  ::gint64 ready_time =
+      ::g_get_monotonic_time() + microseconds(timeout_).count();
+  ::gint64 slack = microseconds(slack_).count();
+  if (slack > 0) {
+    ready_time = (ready_time + slack - 1) / slack * slack;
+  }
+  return ready_time;
+}
+
+auto wait_for_operation_base::create_source() noexcept -> void {
+  trace_point(trace_operation::wait_for, trace_event_kind::start, this);
+  source_ = make_ready_time_source(&dispatch, this);
+  ::g_source_set_ready_time(source_, get_ready_time());
+}
+
+auto wait_for_operation_base::attach_source() noexcept -> void {
+  ::g_source_attach(source_, context_);
+  ::g_source_unref(source_);
+}
+
+auto wait_for_operation_base::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<wait_for_operation_base*>(data);
+  trace_point(trace_operation::wait_for, trace_event_kind::dispatch_begin,
+              data);
+  self.complete_(&self, self.stop_requested_.load());
+  trace_point(trace_operation::wait_for, trace_event_kind::dispatch_end, data);
+  return G_SOURCE_REMOVE;
+}
+
+struct wait_until_operation_base::wait_until_source : ::GSource {
+  gpointer tag_;
+  wait_until_operation_base* op_;
+};
+
+// There is no prepare function. A parked wait costs nothing per loop
+// iteration, stop requests make the source ready by setting its ready time.
+// The check function is only installed to record ready events when tracing.
+::GSourceFuncs wait_until_operation_base::vtable_{
+    nullptr,                                  // prepare
+    tracing_enabled ? &trace_ready : nullptr, // check
+    &dispatch_source,
+    nullptr, // finalize
+    nullptr,
+    nullptr};
+
+wait_until_operation_base::wait_until_operation_base(
+    ::GMainContext* context, int fd, io_condition condition,
+    std::optional<std::chrono::milliseconds> timeout,
+    complete_fn complete) noexcept
+    : context_{context}, fd_{fd}, condition_{condition}, timeout_{timeout},
+      complete_{complete} {}
+
+auto wait_until_operation_base::request_stop() noexcept -> void {
+  stop_requested_.store(true);
+  make_source_ready(source_);
+}
+
+auto wait_until_operation_base::create_source() noexcept -> void {
+  auto source = static_cast<wait_until_source*>(
+      ::g_source_new(&vtable_, sizeof(wait_until_source)));
+  trace_point(trace_operation::wait_until, trace_event_kind::start, this, fd_,
+              condition_);
+  source->op_ = this;
+  source->tag_ =
+      ::g_source_add_unix_fd(source, fd_, get_g_io_condition(condition_));
+  if (timeout_) {
+    // The deadline shares the source with the fd, such that a read with a
+    // timeout costs a single GSource.
+    ::g_source_set_ready_time(source, ::g_get_monotonic_time() +
+                                          std::chrono::microseconds(*timeout_)
+                                              .count());
+  }
+  ::g_source_set_callback(source, &dispatch, this, nullptr);
+  source_ = source;
+}
+
+auto wait_until_operation_base::attach_source() noexcept -> void {
+  ::g_source_attach(source_, context_);
+  ::g_source_unref(source_);
+}
+
+auto wait_until_operation_base::trace_ready(::GSource* source) -> gboolean {
+  auto& self = *static_cast<wait_until_source*>(source);
+  if (::g_source_query_unix_fd(source, self.tag_)) {
+    trace_point(trace_operation::wait_until, trace_event_kind::ready, self.op_,
+                self.op_->fd_, self.op_->condition_);
+  }
+  return false;
+}
+
+auto wait_until_operation_base::dispatch_source(::GSource* source,
+                                                ::GSourceFunc callback,
+                                                gpointer data) -> gboolean {
+  auto& self = *static_cast<wait_until_source*>(source);
+  self.op_->revents_ = ::g_source_query_unix_fd(source, self.tag_);
+  return dispatch_and_drain(source, callback, data);
+}
+
+auto wait_until_operation_base::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<wait_until_operation_base*>(data);
+  int fd = self.fd_;
+  io_condition condition = self.condition_;
+  trace_point(trace_operation::wait_until, trace_event_kind::dispatch_begin,
+              data, fd, condition);
+  if (self.stop_requested_.load()) {
+    self.complete_(&self, result::stopped);
+  } else if (self.revents_ == 0) {
+    self.complete_(&self, result::timed_out);
+  } else {
+    self.complete_(&self, result::ready);
+  }
+  trace_point(trace_operation::wait_until, trace_event_kind::dispatch_end, data,
+              fd, condition);
+  return G_SOURCE_REMOVE;
+}
+
+struct glib_io_context::idle_queue {
+  struct idle_source : ::GSource {
+    idle_queue* queue_;
+  };
+
+  explicit idle_queue(::GMainContext* context) {
+    source_ = static_cast<idle_source*>(
+        ::g_source_new(&vtable_, sizeof(idle_source)));
+    source_->queue_ = this;
+    ::g_source_set_priority(source_, G_PRIORITY_DEFAULT_IDLE);
+    ::g_source_set_callback(source_, &idle_queue::run, this, nullptr);
+    ::g_source_attach(source_, context);
+    // Of default priority, such that cancellation is not held up by a busy
+    // loop.
+    stop_source_ = make_ready_time_source(&idle_queue::complete_stopped, this);
+    ::g_source_attach(stop_source_, context);
+  }
+
+  ~idle_queue() {
+    ::g_source_destroy(stop_source_);
+    ::g_source_unref(stop_source_);
+    ::g_source_destroy(source_);
+    ::g_source_unref(source_);
+  }
+
+  idle_queue(const idle_queue&) = delete;
+  idle_queue& operator=(const idle_queue&) = delete;
+
+  auto push(idle_operation_base* op) noexcept -> void {
+    bool stop_requested = false;
+    {
+      std::lock_guard lock{mutex_};
+      if (tail_) {
+        tail_->next_ = op;
+      } else {
+        head_ = op;
+      }
+      tail_ = op;
+      has_work_.store(true, std::memory_order_relaxed);
+      // Read under the lock: once it is released, the loop thread may pop,
+      // complete and destroy the operation.
+      stop_requested = op->stop_requested_.load();
+    }
+    ::g_main_context_wakeup(::g_source_get_context(source_));
+    // A stop request that arrived before the operation was queued.
+    if (stop_requested) {
+      make_source_ready(stop_source_);
+    }
+  }
+
+  auto request_stop() noexcept -> void { make_source_ready(stop_source_); }
+
+  auto push_front(idle_operation_base* op) noexcept -> void {
+    std::lock_guard lock{mutex_};
+    op->next_ = head_;
+    head_ = op;
+    if (!tail_) {
+      tail_ = op;
+    }
+    has_work_.store(true, std::memory_order_relaxed);
+  }
+
+  auto pop() noexcept -> idle_operation_base* {
+    std::lock_guard lock{mutex_};
+    idle_operation_base* op = head_;
+    if (op) {
+      head_ = op->next_;
+      if (!head_) {
+        tail_ = nullptr;
+        has_work_.store(false, std::memory_order_relaxed);
+      }
+      op->next_ = nullptr;
+    }
+    return op;
+  }
+
+  // Runs operations until the budget of the next one is used up. The first
+  // operation always runs, such that every dispatch makes progress.
+  static auto run(gpointer data) -> gboolean {
+    auto& self = *static_cast<idle_queue*>(data);
+    ::gint64 start = ::g_get_monotonic_time();
+    bool has_run = false;
+    while (idle_operation_base* op = self.pop()) {
+      if (op->stop_requested_.load()) {
+        op->complete_(op, true);
+        continue;
+      }
+      ::gint64 elapsed = ::g_get_monotonic_time() - start;
+      if (has_run && elapsed >= op->scheduler_.get_budget().count()) {
+        self.push_front(op);
+        break;
+      }
+      has_run = true;
+      op->complete_(op, false);
+    }
+    return G_SOURCE_CONTINUE;
+  }
+
+  // Removes the stopped operations from the queue and completes them.
+  static auto complete_stopped(gpointer data) -> gboolean {
+    auto& self = *static_cast<idle_queue*>(data);
+    ::g_source_set_ready_time(self.stop_source_, -1);
+    idle_operation_base* stopped = nullptr;
+    {
+      std::lock_guard lock{self.mutex_};
+      idle_operation_base* previous = nullptr;
+      idle_operation_base* op = self.head_;
+      while (op) {
+        idle_operation_base* next = op->next_;
+        if (op->stop_requested_.load()) {
+          (previous ? previous->next_ : self.head_) = next;
+          if (self.tail_ == op) {
+            self.tail_ = previous;
+          }
+          op->next_ = stopped;
+          stopped = op;
+        } else {
+          previous = op;
+        }
+        op = next;
+      }
+      self.has_work_.store(self.head_ != nullptr, std::memory_order_relaxed);
+    }
+    while (stopped) {
+      idle_operation_base* op = std::exchange(stopped, stopped->next_);
+      op->next_ = nullptr;
+      op->complete_(op, true);
+    }
+    return G_SOURCE_CONTINUE;
+  }
+
+  static ::GSourceFuncs vtable_;
+
+  idle_source* source_{nullptr};
+  ::GSource* stop_source_{nullptr};
+  std::mutex mutex_{};
+  idle_operation_base* head_{nullptr};
+  idle_operation_base* tail_{nullptr};
+  std::atomic<bool> has_work_{false};
+};
+
+// Ready while operations are queued. Being of idle priority, the source is
+// only dispatched if no source of a higher priority is ready.
+::GSourceFuncs glib_io_context::idle_queue::vtable_{
+    [](::GSource* source, int* timeout) -> gboolean {
+      if (timeout) {
+        *timeout = -1;
+      }
+      return static_cast<idle_source*>(source)->queue_->has_work_.load(
+          std::memory_order_relaxed);
+    },       // prepare
+    nullptr, // check
+    &dispatch_and_drain,
+    nullptr, // finalize
+    nullptr,
+    nullptr};
+
+auto idle_operation_base::request_stop() noexcept -> void {
+  stop_requested_.store(true);
+  scheduler_.context_->idle_queue_->request_stop();
+}
+
+auto idle_operation_base::start_idle() noexcept -> void {
+  scheduler_.context_->idle_queue_->push(this);
+}
+
+auto tag_invoke(stdexec::schedule_t, idle_scheduler self) noexcept
+    -> idle_schedule_sender {
+  return idle_schedule_sender{self};
+}
+
+auto glib_io_context::get_idle_queue() -> idle_queue& {
+  std::call_once(idle_queue_once_, [this] {
+    idle_queue_ = std::make_unique<idle_queue>(context_.get());
+  });
+  return *idle_queue_;
+}
+
+auto glib_io_context::get_idle_scheduler(std::chrono::microseconds budget)
+    -> idle_scheduler {
+  get_idle_queue();
+  return idle_scheduler{*this, budget};
+}
+
+glib_io_context::~glib_io_context() = default;
+
 auto glib_scheduler::get_GMainContext() const noexcept -> ::GMainContext* {
   return context_->context_.get();
 }
@@ -23,7 +523,7 @@ auto tag_invoke(stdexec::schedule_t, glib_scheduler self) noexcept
 auto tag_invoke(exec::schedule_after_t, glib_scheduler self,
                 std::chrono::system_clock::duration dur) noexcept -> wait_for_sender {
   auto mil = std::chrono::duration_cast<std::chrono::milliseconds>(dur);
-  return wait_for_sender{self.get_GMainContext(), mil};
+  return wait_for_sender{self.get_GMainContext(), mil, self.timer_slack_};
 }
 
 auto tag_invoke(wait_until_t, glib_scheduler self, int fd,
@@ -31,11 +531,26 @@ auto tag_invoke(wait_until_t, glib_scheduler self, int fd,
   return wait_until_sender{self, fd, condition};
 }
 
+auto tag_invoke(wait_until_t, glib_scheduler self, int fd,
+                io_condition condition,
+                std::chrono::system_clock::duration timeout) noexcept
+    -> wait_until_sender {
+  auto mil = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+  return wait_until_sender{self, fd, condition, mil};
+}
+
 glib_scheduler::glib_scheduler() noexcept {
   static glib_io_context ctx{};
   context_ = &ctx;
 }
 
+auto glib_scheduler::with_timer_slack(
+    std::chrono::milliseconds slack) const noexcept -> glib_scheduler {
+  glib_scheduler scheduler{*this};
+  scheduler.timer_slack_ = slack;
+  return scheduler;
+}
+
 auto glib_io_context::get_scheduler() noexcept -> glib_scheduler {
   return glib_scheduler{*this};
 }
@@ -1,10 +1,17 @@
 #ifndef GLIB_SENDERS_GLIB_IO_CONTEXT_HPP
 #define GLIB_SENDERS_GLIB_IO_CONTEXT_HPP
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
 
 #include <stdexec/execution.hpp>
 #include <stdexec/stop_token.hpp>
@@ -13,6 +20,8 @@
 
 #include "glib.h"
 
+#include "glib-senders/trace.hpp"
+
 namespace gsenders {
 using stdexec::nothrow_tag_invocable;
 using stdexec::tag_invocable;
@@ -26,6 +35,9 @@ struct wait_until_t;
 class schedule_sender;
 class wait_for_sender;
 class wait_until_sender;
+class idle_scheduler;
+class idle_schedule_sender;
+class idle_operation_base;
 
 enum class io_condition { is_readable = 1, is_writeable = 2, is_error = 4 };
 auto operator|(io_condition, io_condition) noexcept -> io_condition;
@@ -36,9 +48,27 @@ public:
   glib_scheduler() noexcept;
   explicit glib_scheduler(glib_io_context& ctx) : context_{&ctx} {}
 
+  /// @brief Get a scheduler whose timers may fire up to `slack` late.
+  ///
+  /// Deadlines of timers created by exec::schedule_after are rounded up to the
+  /// next multiple of `slack` on the monotonic clock. All timers that fall into
+  /// the same slot share a single wakeup of the event loop, similar to
+  /// g_timeout_add_seconds. A slack of zero gives exact timers.
+  [[nodiscard]] auto
+  with_timer_slack(std::chrono::milliseconds slack) const noexcept
+      -> glib_scheduler;
+
+  [[nodiscard]] auto get_timer_slack() const noexcept
+      -> std::chrono::milliseconds {
+    return timer_slack_;
+  }
+
 private:
   friend class schedule_sender;
   friend class wait_until_sender;
+  friend class io_thread_pool;
+  friend class selector;
+  friend class gio_operation_base;
 
   auto get_GMainContext() const noexcept -> ::GMainContext*;
 
@@ -57,10 +87,18 @@ private:
   friend auto tag_invoke(wait_until_t, glib_scheduler self, int fd,
                          io_condition condition) noexcept -> wait_until_sender;
 
-  friend bool operator==(const glib_scheduler&,
-                         const glib_scheduler&) = default;
+  friend auto tag_invoke(wait_until_t, glib_scheduler self, int fd,
+                         io_condition condition,
+                         std::chrono::system_clock::duration timeout) noexcept
+      -> wait_until_sender;
+
+  friend bool operator==(const glib_scheduler& lhs,
+                         const glib_scheduler& rhs) noexcept {
+    return lhs.context_ == rhs.context_;
+  }
 
   glib_io_context* context_;
+  std::chrono::milliseconds timer_slack_{};
 };
 
 struct wait_until_t {
@@ -75,6 +113,44 @@ struct wait_until_t {
 };
 inline constexpr wait_until_t wait_until{};
 
+/// @brief A scheduler for background work that runs only when the event loop
+/// is otherwise idle.
+///
+/// Operations are queued per context and run from a single GSource with
+/// G_PRIORITY_DEFAULT_IDLE, such that GLib dispatches them only if no source
+/// of a higher priority is ready. A dispatch runs queued operations until it
+/// has used up the time budget of the next operation and then yields back to
+/// the loop. Stop requests of queued operations are also served from the idle
+/// dispatch.
+class idle_scheduler {
+public:
+  static constexpr std::chrono::microseconds default_budget{1000};
+
+  [[nodiscard]] auto get_budget() const noexcept -> std::chrono::microseconds {
+    return budget_;
+  }
+
+private:
+  friend class glib_io_context;
+  friend class idle_schedule_sender;
+  friend class idle_operation_base;
+
+  idle_scheduler(glib_io_context& context,
+                 std::chrono::microseconds budget) noexcept
+      : context_{&context}, budget_{budget} {}
+
+  friend auto tag_invoke(stdexec::schedule_t, idle_scheduler self) noexcept
+      -> idle_schedule_sender;
+
+  friend bool operator==(const idle_scheduler& lhs,
+                         const idle_scheduler& rhs) noexcept {
+    return lhs.context_ == rhs.context_;
+  }
+
+  glib_io_context* context_;
+  std::chrono::microseconds budget_;
+};
+
 class glib_io_context {
 public:
   glib_io_context();
@@ -86,8 +162,18 @@ public:
   glib_io_context(glib_io_context&&) = delete;
   glib_io_context& operator=(glib_io_context&&) = delete;
 
+  ~glib_io_context();
+
   [[nodiscard]] auto get_scheduler() noexcept -> glib_scheduler;
 
+  /// @brief Get a scheduler for work that only runs when the loop is idle.
+  ///
+  /// @param budget the time an idle dispatch may have used before an
+  /// operation of this scheduler is deferred to the next idle dispatch
+  [[nodiscard]] auto get_idle_scheduler(
+      std::chrono::microseconds budget = idle_scheduler::default_budget)
+      -> idle_scheduler;
+
   auto run() -> void;
 
   auto stop() -> void;
@@ -103,78 +189,186 @@ private:
     void operator()(::GMainLoop* pointer) const noexcept;
   };
   std::unique_ptr<::GMainLoop, loop_destroy> loop_{nullptr};
+
+  friend class schedule_operation_base;
+  // Schedule operations that wait for a GSource of this context. While there
+  // are any, schedule() does not run inline, such that it cannot overtake them.
+  std::atomic<std::size_t> pending_schedules_{0};
+
+  friend class idle_operation_base;
+  struct idle_queue;
+  auto get_idle_queue() -> idle_queue&;
+  std::once_flag idle_queue_once_{};
+  // Declared after the context, such that the queue is destroyed first.
+  std::unique_ptr<idle_queue> idle_queue_{nullptr};
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 // Implementation
 
-template <typename Receiver> class schedule_operation {
+/// @brief Converts to the result of a callable.
+///
+/// Used to emplace immovable operation states into a std::optional.
+template <class Fn> struct emplace_from {
+  Fn fn_;
+  operator std::invoke_result_t<Fn>() && { return std::move(fn_)(); }
+};
+template <class Fn> emplace_from(Fn) -> emplace_from<Fn>;
+
+/// @brief The set_value signature of a sender that completes with a Value, or
+/// without a value if it is void.
+template <class Value> struct value_signature {
+  using type = stdexec::set_value_t(Value);
+};
+template <> struct value_signature<void> {
+  using type = stdexec::set_value_t();
+};
+template <class Value>
+using value_signature_t = typename value_signature<Value>::type;
+
+/// @brief An operation that can run from the run queue of the current dispatch.
+struct inline_operation {
+  inline_operation* next_{nullptr};
+  void (*execute_)(inline_operation*) noexcept = nullptr;
+};
+
+/// @brief Queue an operation if the calling thread is dispatching a source of
+/// the given context.
+///
+/// Queued operations run in FIFO order as soon as the current dispatch
+/// returns, without going through prepare, poll and dispatch again. Operations
+/// which are queued while the queue is drained run in the same pass, up to a
+/// fixed limit. The remaining operations move to a new GSource such that other
+/// sources are not starved.
+///
+/// Nothing is queued while `pending` is non-zero, which counts the operations
+/// of the context that wait for a GSource, including such an overflow source.
+/// An operation that is started later thus never completes before them.
+///
+/// @return true if the operation has been queued
+auto try_schedule_inline(::GMainContext* context,
+                         std::atomic<std::size_t>& pending,
+                         inline_operation* op) noexcept -> bool;
+
+/// @brief Invoke a GSource callback and drain the operations that have been
+/// queued inline while it was running.
+///
+/// All GSources of this library dispatch through this function.
+auto dispatch_and_drain(::GSource* source, ::GSourceFunc callback,
+                        gpointer data) noexcept -> gboolean;
+
+/// @brief Create a source that has no prepare or check function.
+///
+/// The source only becomes ready through its ready time and the unix fds that
+/// are added to it, so it costs nothing per loop iteration while it is idle.
+/// It dispatches through dispatch_and_drain() and is not attached yet.
+auto make_ready_time_source(::GSourceFunc callback, gpointer data) noexcept
+    -> ::GSource*;
+
+/// @brief Make a source ready in the next iteration of its context.
+///
+/// Thread-safe and wakes up the owning context if necessary.
+auto make_source_ready(::GSource* source) noexcept -> void;
+
+/// @brief Get the poll events that make a fd ready for the given condition.
+///
+/// Errors and hang-ups always make a fd ready.
+auto get_g_io_condition(io_condition condition) noexcept -> ::GIOCondition;
+
+inline auto trace_point(trace_operation operation, trace_event_kind kind,
+                        const void* op, int fd = -1,
+                        io_condition condition = {}) noexcept -> void {
+  if constexpr (tracing_enabled) {
+    record_trace_event(operation, kind, op, fd, static_cast<int>(condition));
+  }
+}
+
+/// @brief The receiver-independent part of a schedule operation.
+///
+/// The GSource vtable, the callbacks and the trace points of all schedule
+/// operations are compiled once into the library. The templated operation only
+/// adds the receiver and its stop callback.
+class schedule_operation_base : inline_operation {
+public:
+  schedule_operation_base(const schedule_operation_base&) = delete;
+  schedule_operation_base& operator=(const schedule_operation_base&) = delete;
+
+  /// @brief Complete the operation as stopped with its next dispatch.
+  /// Thread-safe.
+  auto request_stop() noexcept -> void;
+
+protected:
+  /// Invoked on the event loop, `stopped` is true if request_stop() has been
+  /// called before.
+  using complete_fn = void (*)(schedule_operation_base*, bool stopped) noexcept;
+
+  schedule_operation_base(glib_io_context& context,
+                          complete_fn complete) noexcept;
+  ~schedule_operation_base() = default;
+
+  /// @brief Queue the operation into the run queue of the current dispatch.
+  ///
+  /// @return false if the caller needs to call start_source() instead
+  auto try_start_inline() noexcept -> bool;
+
+  /// @brief Attach a GSource that completes the operation with the next
+  /// iteration of the context.
+  auto start_source() noexcept -> void;
+
 private:
-  inline static ::GSourceFuncs vtable_{
-      [](::GSource*, int* timeout) -> gboolean {
-        if (timeout) {
-          *timeout = -1;
-        }
-        return true;
-      },       // prepare
-      nullptr, // check
-      [](::GSource*, ::GSourceFunc callback, gpointer data) -> gboolean {
-        if (callback) {
-          return callback(data);
-        }
-        return G_SOURCE_REMOVE;
-      },       // dispatch
-      nullptr, // finalize
-      nullptr,
-      nullptr};
+  static auto execute(inline_operation* op) noexcept -> void;
+  static auto dispatch(gpointer data) -> gboolean;
 
-  [[no_unique_address]] Receiver receiver_;
   ::GMainContext* context_;
+  std::atomic<std::size_t>* pending_;
+  complete_fn complete_;
+  std::atomic<bool> stop_requested_{false};
+};
+
+template <typename Receiver>
+class schedule_operation : schedule_operation_base {
+private:
+  [[no_unique_address]] Receiver receiver_;
 
   struct on_stop_requested {
-    stdexec::in_place_stop_source& stop_source_;
-    ::GMainContext* context_;
-    void operator()() noexcept {
-      stop_source_.request_stop();
-      ::g_main_context_wakeup(context_);
-    }
+    schedule_operation_base& op_;
+    void operator()() noexcept { op_.request_stop(); }
   };
-  stdexec::in_place_stop_source stop_source_{};
   using on_stop = std::optional<typename stdexec::stop_token_of_t<
       stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
   on_stop on_stop_{};
 
+  static auto complete(schedule_operation_base* base, bool stopped) noexcept
+      -> void {
+    auto& self = *static_cast<schedule_operation*>(base);
+    try {
+      self.on_stop_.reset();
+      if (stopped || stdexec::get_stop_token(stdexec::get_env(self.receiver_))
+                         .stop_requested()) {
+        stdexec::set_stopped(std::move(self.receiver_));
+      } else {
+        stdexec::set_value(std::move(self.receiver_));
+      }
+    } catch (...) {
+      stdexec::set_error(std::move(self.receiver_), std::current_exception());
+    }
+  }
+
   friend auto tag_invoke(stdexec::start_t, schedule_operation& self) noexcept
       -> void {
+    if (self.try_start_inline()) {
+      return;
+    }
     self.on_stop_.emplace(
         stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
-        on_stop_requested{self.stop_source_, self.context_});
-    ::GSource* source = ::g_source_new(&vtable_, sizeof(::GSource));
-    ::g_source_set_callback(
-        source,
-        [](gpointer data) -> gboolean {
-          auto& self = *static_cast<schedule_operation*>(data);
-          try {
-            self.on_stop_.reset();
-            if (self.stop_source_.stop_requested()) {
-              stdexec::set_stopped(std::move(self.receiver_));
-            } else {
-              stdexec::set_value(std::move(self.receiver_));
-            }
-          } catch (...) {
-            stdexec::set_error(std::move(self.receiver_),
-                               std::current_exception());
-          }
-          return G_SOURCE_REMOVE;
-        },
-        &self, nullptr);
-    ::g_source_attach(source, self.context_);
-    ::g_source_unref(source);
+        on_stop_requested{self});
+    self.start_source();
   }
 
 public:
-  schedule_operation(::GMainContext* context, Receiver&& receiver)
-      : receiver_{std::move(receiver)}, context_{context} {}
+  schedule_operation(glib_io_context& context, Receiver&& receiver)
+      : schedule_operation_base{context, &complete},
+        receiver_{std::move(receiver)} {}
   schedule_operation(schedule_operation&&) = delete;
 };
 
@@ -182,7 +376,8 @@ class schedule_sender {
 public:
   using completion_signatures =
       stdexec::completion_signatures<stdexec::set_value_t(),
-                                     stdexec::set_error_t(std::exception_ptr)>;
+                                     stdexec::set_error_t(std::exception_ptr),
+                                     stdexec::set_stopped_t()>;
 
   explicit schedule_sender(glib_scheduler scheduler) : scheduler_(scheduler) {}
 
@@ -198,10 +393,6 @@ public:
 private:
   glib_scheduler scheduler_;
 
-  auto get_GMainContext() const noexcept -> ::GMainContext* {
-    return scheduler_.get_GMainContext();
-  }
-
   template <typename R>
   requires stdexec::receiver<R>
   friend auto
@@ -210,7 +401,7 @@ private:
                                         is_nothrow_constructible_v<
                                             std::remove_cvref_t<R>, R>)
       -> schedule_operation<std::remove_cvref_t<R>> {
-    return {self.get_GMainContext(), std::forward<R>(receiver)};
+    return {*self.scheduler_.context_, std::forward<R>(receiver)};
   }
 
   friend attrs tag_invoke(stdexec::get_env_t,
@@ -219,50 +410,84 @@ private:
   }
 };
 
+/// @brief The receiver-independent part of a timer operation.
+class wait_for_operation_base {
+public:
+  wait_for_operation_base(const wait_for_operation_base&) = delete;
+  wait_for_operation_base& operator=(const wait_for_operation_base&) = delete;
+
+  /// @brief Make the timer fire immediately and complete as stopped.
+  /// Thread-safe.
+  auto request_stop() noexcept -> void;
+
+protected:
+  using complete_fn = void (*)(wait_for_operation_base*, bool stopped) noexcept;
+
+  wait_for_operation_base(::GMainContext* context,
+                          std::chrono::milliseconds timeout,
+                          std::chrono::milliseconds slack,
+                          complete_fn complete) noexcept;
+  ~wait_for_operation_base() = default;
+
+  /// @brief Create the GSource and set its deadline.
+  ///
+  /// Stop requests are accepted from here on, the source fires only after
+  /// attach_source().
+  auto create_source() noexcept -> void;
+  auto attach_source() noexcept -> void;
+
+private:
+  auto get_ready_time() const noexcept -> ::gint64;
+  static auto dispatch(gpointer data) -> gboolean;
+
+  ::GMainContext* context_;
+  std::chrono::milliseconds timeout_;
+  std::chrono::milliseconds slack_;
+  complete_fn complete_;
+  ::GSource* source_{nullptr};
+  std::atomic<bool> stop_requested_{false};
+};
+
 template <typename Receiver>
 requires stdexec::receiver<Receiver>
-struct wait_for_operation {
-  [[no_unique_address]] Receiver receiver_{};
-  ::GMainContext* context_{nullptr};
-  std::chrono::milliseconds timeout_{};
+class wait_for_operation : wait_for_operation_base {
+private:
+  [[no_unique_address]] Receiver receiver_;
 
   struct on_stop_requested {
-    stdexec::in_place_stop_source& stop_source_;
-    ::GMainContext* context_;
-    GSource* source_;
-    void operator()() noexcept {
-      stop_source_.request_stop();
-      ::g_source_set_ready_time(source_, 0);
-      ::g_main_context_wakeup(context_);
-    }
+    wait_for_operation_base& op_;
+    void operator()() noexcept { op_.request_stop(); }
   };
-  stdexec::in_place_stop_source stop_source_{};
   using on_stop = std::optional<typename stdexec::stop_token_of_t<
       stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
   on_stop on_stop_{};
 
+  static auto complete(wait_for_operation_base* base, bool stopped) noexcept
+      -> void {
+    auto& self = *static_cast<wait_for_operation*>(base);
+    self.on_stop_.reset();
+    if (stopped) {
+      stdexec::set_stopped(std::move(self.receiver_));
+    } else {
+      stdexec::set_value(std::move(self.receiver_));
+    }
+  }
+
   friend auto tag_invoke(stdexec::start_t, wait_for_operation& op) noexcept
       -> void {
-    ::GSource* source = ::g_timeout_source_new(op.timeout_.count());
-    op.on_stop_.emplace(
-        stdexec::get_stop_token(stdexec::get_env(op.receiver_)),
-        on_stop_requested{op.stop_source_, op.context_, source});
-    ::g_source_set_callback(
-        source,
-        [](gpointer data) -> gboolean {
-          auto& self = *static_cast<wait_for_operation*>(data);
-          self.on_stop_.reset();
-          if (self.stop_source_.stop_requested()) {
-            stdexec::set_stopped(std::move(self.receiver_));
-          } else {
-            stdexec::set_value(std::move(self.receiver_));
-          }
-          return G_SOURCE_REMOVE;
-        },
-        &op, nullptr);
-    ::g_source_attach(source, op.context_);
-    ::g_source_unref(source);
+    op.create_source();
+    op.on_stop_.emplace(stdexec::get_stop_token(stdexec::get_env(op.receiver_)),
+                        on_stop_requested{op});
+    op.attach_source();
   }
+
+public:
+  wait_for_operation(Receiver&& receiver, ::GMainContext* context,
+                     std::chrono::milliseconds timeout,
+                     std::chrono::milliseconds slack)
+      : wait_for_operation_base{context, timeout, slack, &complete},
+        receiver_{std::move(receiver)} {}
+  wait_for_operation(wait_for_operation&&) = delete;
 };
 
 struct wait_for_sender {
@@ -272,104 +497,118 @@ struct wait_for_sender {
 
   ::GMainContext* context_{nullptr};
   std::chrono::milliseconds timeout_{};
+  std::chrono::milliseconds slack_{};
 
   template <typename Receiver>
   requires stdexec::receiver<Receiver>
   friend auto tag_invoke(stdexec::connect_t, wait_for_sender self,
                          Receiver&& receiver)
       -> wait_for_operation<std::remove_cvref_t<Receiver>> {
-    return {std::forward<Receiver>(receiver), self.context_, self.timeout_};
+    return {std::forward<Receiver>(receiver), self.context_, self.timeout_,
+            self.slack_};
   }
 };
 
-template <typename Receiver> struct wait_until_operation {
-  ::GMainContext* context_{nullptr};
-  int fd_{};
-  io_condition condition_{};
-  Receiver receiver_{};
+/// @brief The receiver-independent part of an fd operation.
+class wait_until_operation_base {
+public:
+  wait_until_operation_base(const wait_until_operation_base&) = delete;
+  wait_until_operation_base&
+  operator=(const wait_until_operation_base&) = delete;
 
-  struct wait_until_source : ::GSource {
-    stdexec::in_place_stop_source* stop_source_;
-  };
-  inline static GSourceFuncs vtable_{
-      [](::GSource* source, int* timeout) -> gboolean {
-        if (timeout) {
-          *timeout = -1;
-        }
-        if (source) {
-          auto& self = *static_cast<wait_until_source*>(source);
-          return self.stop_source_->stop_requested();
-        }
-        return true;
-      },       // prepare
-      nullptr, // check
-      [](::GSource*, ::GSourceFunc callback, gpointer data) -> gboolean {
-        if (callback) {
-          return callback(data);
-        }
-        return G_SOURCE_REMOVE;
-      },       // dispatch
-      nullptr, // finalize
-      nullptr,
-      nullptr};
+  /// @brief Make the source ready and complete as stopped. Thread-safe.
+  auto request_stop() noexcept -> void;
+
+protected:
+  enum class result { ready, timed_out, stopped };
+  using complete_fn = void (*)(wait_until_operation_base*, result) noexcept;
+
+  wait_until_operation_base(::GMainContext* context, int fd,
+                            io_condition condition,
+                            std::optional<std::chrono::milliseconds> timeout,
+                            complete_fn complete) noexcept;
+  ~wait_until_operation_base() = default;
+
+  /// @brief Create the GSource, add the fd and set the deadline.
+  ///
+  /// Stop requests are accepted from here on, the source fires only after
+  /// attach_source().
+  auto create_source() noexcept -> void;
+  auto attach_source() noexcept -> void;
+
+  [[nodiscard]] auto get_fd() const noexcept -> int { return fd_; }
+
+private:
+  struct wait_until_source;
+  static ::GSourceFuncs vtable_;
+  static auto trace_ready(::GSource* source) -> gboolean;
+  static auto dispatch_source(::GSource* source, ::GSourceFunc callback,
+                              gpointer data) -> gboolean;
+  static auto dispatch(gpointer data) -> gboolean;
+
+  ::GMainContext* context_;
+  int fd_;
+  io_condition condition_;
+  std::optional<std::chrono::milliseconds> timeout_;
+  complete_fn complete_;
+  ::GSource* source_{nullptr};
+  ::GIOCondition revents_{};
+  std::atomic<bool> stop_requested_{false};
+};
+
+template <typename Receiver>
+class wait_until_operation : wait_until_operation_base {
+private:
+  [[no_unique_address]] Receiver receiver_;
 
   struct on_stop_requested {
-    stdexec::in_place_stop_source& stop_source_;
-    ::GMainContext* context_;
-    void operator()() noexcept {
-      stop_source_.request_stop();
-      ::g_main_context_wakeup(context_);
-    }
+    wait_until_operation_base& op_;
+    void operator()() noexcept { op_.request_stop(); }
   };
-  stdexec::in_place_stop_source stop_source_{};
   using on_stop = std::optional<typename stdexec::stop_token_of_t<
       stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
   on_stop on_stop_{};
 
-  ::GIOCondition get_g_io_condition() {
-    ::GIOCondition g_condition{};
-    if (condition_ & io_condition::is_readable) {
-      g_condition = (GIOCondition)(g_condition | G_IO_IN | G_IO_ERR | G_IO_HUP);
-    }
-    if (condition_ & io_condition::is_writeable) {
-      g_condition =
-          (GIOCondition)(g_condition | G_IO_OUT | G_IO_ERR | G_IO_HUP);
+  static auto complete(wait_until_operation_base* base, result r) noexcept
+      -> void {
+    auto& self = *static_cast<wait_until_operation*>(base);
+    try {
+      self.on_stop_.reset();
+      switch (r) {
+      case result::stopped:
+        stdexec::set_stopped(std::move(self.receiver_));
+        break;
+      case result::timed_out:
+        stdexec::set_error(std::move(self.receiver_),
+                           std::make_exception_ptr(std::system_error(
+                               std::make_error_code(std::errc::timed_out))));
+        break;
+      case result::ready:
+        stdexec::set_value(std::move(self.receiver_), self.get_fd());
+        break;
+      }
+    } catch (...) {
+      stdexec::set_error(std::move(self.receiver_), std::current_exception());
     }
-    return g_condition;
   }
 
   friend auto tag_invoke(stdexec::start_t, wait_until_operation& op) noexcept
       -> void {
-    auto source = static_cast<wait_until_source*>(
-        ::g_source_new(&vtable_, sizeof(wait_until_source)));
-    source->stop_source_ = &op.stop_source_;
+    op.create_source();
+    // Registered after the deadline, such that an early stop request is not
+    // overwritten by it.
     op.on_stop_.emplace(stdexec::get_stop_token(stdexec::get_env(op.receiver_)),
-                        on_stop_requested{op.stop_source_, op.context_});
-    ::g_source_add_unix_fd(source, op.fd_, op.get_g_io_condition());
-    ::g_source_set_callback(
-        source,
-        [](gpointer data) -> gboolean {
-          if (!data) {
-            return G_SOURCE_REMOVE;
-          }
-          auto& self = *static_cast<wait_until_operation*>(data);
-          try {
-            self.on_stop_.reset();
-            if (self.stop_source_.stop_requested()) {
-              stdexec::set_stopped(std::move(self.receiver_));
-            } else {
-              stdexec::set_value(std::move(self.receiver_), self.fd_);
-            }
-          } catch (...) {
-            stdexec::set_error(std::move(self.receiver_),
-                               std::current_exception());
-          }
-          return G_SOURCE_REMOVE;
-        },
-        &op, nullptr);
-    ::g_source_attach(source, op.context_);
-    ::g_source_unref(source);
+                        on_stop_requested{op});
+    op.attach_source();
   }
+
+public:
+  wait_until_operation(::GMainContext* context, int fd, io_condition condition,
+                       Receiver&& receiver,
+                       std::optional<std::chrono::milliseconds> timeout)
+      : wait_until_operation_base{context, fd, condition, timeout, &complete},
+        receiver_{std::move(receiver)} {}
+  wait_until_operation(wait_until_operation&&) = delete;
 };
 
 struct wait_until_sender {
@@ -380,6 +619,7 @@ struct wait_until_sender {
   glib_scheduler scheduler_;
   int fd_{};
   io_condition condition_;
+  std::optional<std::chrono::milliseconds> timeout_{};
 
   auto get_GMainContext() const noexcept -> ::GMainContext* {
     return scheduler_.get_GMainContext();
@@ -391,7 +631,7 @@ struct wait_until_sender {
                          Receiver&& receiver)
       -> wait_until_operation<std::remove_cvref_t<Receiver>> {
     return {self.get_GMainContext(), self.fd_, self.condition_,
-            std::forward<Receiver>(receiver)};
+            std::forward<Receiver>(receiver), self.timeout_};
   }
 
   struct attrs {
@@ -409,6 +649,114 @@ struct wait_until_sender {
   }
 };
 
+/// @brief The receiver-independent part of an idle operation.
+class idle_operation_base {
+public:
+  idle_operation_base(const idle_operation_base&) = delete;
+  idle_operation_base& operator=(const idle_operation_base&) = delete;
+
+  /// @brief Complete the operation as stopped in the next loop iteration,
+  /// even if the loop never becomes idle. Thread-safe.
+  auto request_stop() noexcept -> void;
+
+protected:
+  using complete_fn = void (*)(idle_operation_base*, bool stopped) noexcept;
+
+  idle_operation_base(idle_scheduler scheduler, complete_fn complete) noexcept
+      : scheduler_{scheduler}, complete_{complete} {}
+  ~idle_operation_base() = default;
+
+  /// @brief Queue the operation. Thread-safe.
+  auto start_idle() noexcept -> void;
+
+private:
+  friend class glib_io_context;
+
+  idle_scheduler scheduler_;
+  complete_fn complete_;
+  idle_operation_base* next_{nullptr};
+  std::atomic<bool> stop_requested_{false};
+};
+
+template <typename Receiver>
+class idle_operation : idle_operation_base {
+private:
+  [[no_unique_address]] Receiver receiver_;
+
+  struct on_stop_requested {
+    idle_operation_base& op_;
+    void operator()() noexcept { op_.request_stop(); }
+  };
+  using on_stop = std::optional<typename stdexec::stop_token_of_t<
+      stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto complete(idle_operation_base* base, bool stopped) noexcept
+      -> void {
+    auto& self = *static_cast<idle_operation*>(base);
+    try {
+      self.on_stop_.reset();
+      if (stopped) {
+        stdexec::set_stopped(std::move(self.receiver_));
+      } else {
+        stdexec::set_value(std::move(self.receiver_));
+      }
+    } catch (...) {
+      stdexec::set_error(std::move(self.receiver_), std::current_exception());
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t, idle_operation& self) noexcept
+      -> void {
+    self.on_stop_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
+        on_stop_requested{self});
+    self.start_idle();
+  }
+
+public:
+  idle_operation(idle_scheduler scheduler, Receiver&& receiver)
+      : idle_operation_base{scheduler, &complete},
+        receiver_{std::move(receiver)} {}
+  idle_operation(idle_operation&&) = delete;
+};
+
+class idle_schedule_sender {
+public:
+  using completion_signatures =
+      stdexec::completion_signatures<stdexec::set_value_t(),
+                                     stdexec::set_error_t(std::exception_ptr),
+                                     stdexec::set_stopped_t()>;
+
+  explicit idle_schedule_sender(idle_scheduler scheduler) noexcept
+      : scheduler_{scheduler} {}
+
+  struct attrs {
+    idle_scheduler scheduler_;
+    friend idle_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  idle_scheduler scheduler_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const idle_schedule_sender& self,
+                         R&& receiver)
+      -> idle_operation<std::remove_cvref_t<R>> {
+    return {self.scheduler_, std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const idle_schedule_sender& self) noexcept {
+    return attrs{self.scheduler_};
+  }
+};
+
 } // namespace gsenders
 
 #endif
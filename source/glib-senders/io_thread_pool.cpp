@@ -0,0 +1,195 @@
+#include "glib-senders/io_thread_pool.hpp"
+
+#include <cerrno>
+
+namespace gsenders {
+
+auto run_request(int fd, pread_request& request) noexcept -> std::error_code {
+  ssize_t nbytes =
+      ::pread(fd, request.buffer.data(), request.buffer.size(), request.offset);
+  if (nbytes == -1) {
+    return {errno, std::system_category()};
+  }
+  request.result = request.buffer.subspan(0, nbytes);
+  return {};
+}
+
+auto run_request(int fd, pwrite_request& request) noexcept -> std::error_code {
+  ssize_t nbytes = ::pwrite(fd, request.buffer.data(), request.buffer.size(),
+                            request.offset);
+  if (nbytes == -1) {
+    return {errno, std::system_category()};
+  }
+  request.result = request.buffer.subspan(nbytes);
+  return {};
+}
+
+io_thread_pool::io_thread_pool(glib_scheduler scheduler,
+                               std::size_t thread_count)
+    : scheduler_{scheduler} {
+  source_ = make_ready_time_source(&io_thread_pool::complete_all, this);
+  ::g_source_attach(source_, scheduler_.get_GMainContext());
+  try {
+    threads_.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+      threads_.emplace_back([this] { run_worker(); });
+    }
+  } catch (...) {
+    shutdown();
+    throw;
+  }
+}
+
+io_thread_pool::~io_thread_pool() { shutdown(); }
+
+auto io_thread_pool::shutdown() noexcept -> void {
+  {
+    std::lock_guard lock{mutex_};
+    stopped_ = true;
+  }
+  condition_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  if (source_) {
+    ::g_source_destroy(source_);
+    ::g_source_unref(std::exchange(source_, nullptr));
+  }
+  // No other thread touches the lists anymore, request_stop() returns early
+  // once stopped_ is set.
+  io_work* completed = std::exchange(completed_head_, nullptr);
+  io_work* submitted = std::exchange(submitted_head_, nullptr);
+  completed_tail_ = nullptr;
+  submitted_tail_ = nullptr;
+  while (completed) {
+    io_work* work = std::exchange(completed, completed->next_);
+    work->next_ = nullptr;
+    work->complete_(work, work->stopped_);
+  }
+  while (submitted) {
+    io_work* work = std::exchange(submitted, submitted->next_);
+    work->next_ = nullptr;
+    work->stopped_ = true;
+    work->complete_(work, true);
+  }
+}
+
+auto io_thread_pool::submit(io_work* first) noexcept -> void {
+  io_work* last = first;
+  bool is_batch = false;
+  while (last->next_) {
+    last = last->next_;
+    is_batch = true;
+  }
+  {
+    std::lock_guard lock{mutex_};
+    if (submitted_tail_) {
+      submitted_tail_->next_ = first;
+    } else {
+      submitted_head_ = first;
+    }
+    submitted_tail_ = last;
+  }
+  if (is_batch) {
+    condition_.notify_all();
+  } else {
+    condition_.notify_one();
+  }
+}
+
+auto io_thread_pool::request_stop(io_work* work) noexcept -> void {
+  work->stop_requested_.store(true);
+  std::lock_guard lock{mutex_};
+  if (stopped_) {
+    return;
+  }
+  io_work* previous = nullptr;
+  for (io_work* queued = submitted_head_; queued;
+       previous = std::exchange(queued, queued->next_)) {
+    if (queued != work) {
+      continue;
+    }
+    (previous ? previous->next_ : submitted_head_) = work->next_;
+    if (submitted_tail_ == work) {
+      submitted_tail_ = previous;
+    }
+    work->next_ = nullptr;
+    work->stopped_ = true;
+    // Readied with the lock held, such that shutdown() cannot destroy the
+    // source in the meantime.
+    if (push_completed(work)) {
+      make_source_ready(source_);
+    }
+    return;
+  }
+}
+
+// Requires mutex_ to be held. Returns true if the list has been empty, in
+// which case the event loop has to be woken up.
+auto io_thread_pool::push_completed(io_work* work) noexcept -> bool {
+  bool was_empty = completed_head_ == nullptr;
+  if (completed_tail_) {
+    completed_tail_->next_ = work;
+  } else {
+    completed_head_ = work;
+  }
+  completed_tail_ = work;
+  return was_empty;
+}
+
+auto io_thread_pool::run_worker() noexcept -> void {
+  while (true) {
+    io_work* work = nullptr;
+    {
+      std::unique_lock lock{mutex_};
+      condition_.wait(lock, [this] { return stopped_ || submitted_head_; });
+      if (stopped_) {
+        return;
+      }
+      work = submitted_head_;
+      submitted_head_ = work->next_;
+      if (!submitted_head_) {
+        submitted_tail_ = nullptr;
+      }
+      work->next_ = nullptr;
+    }
+    // Stopped after it has been taken from the queue, or before it has been
+    // submitted.
+    bool withdrawn = work->stop_requested_.load();
+    if (!withdrawn) {
+      work->execute_(work);
+    }
+    bool needs_wakeup = false;
+    {
+      std::lock_guard lock{mutex_};
+      work->stopped_ = withdrawn;
+      needs_wakeup = push_completed(work);
+    }
+    // Only the first completion of a batch wakes up the event loop.
+    if (needs_wakeup) {
+      make_source_ready(source_);
+    }
+  }
+}
+
+auto io_thread_pool::complete_all(gpointer data) -> gboolean {
+  auto& self = *static_cast<io_thread_pool*>(data);
+  // Disarm before taking the list, such that a completion which is pushed
+  // concurrently re-arms the source.
+  ::g_source_set_ready_time(self.source_, -1);
+  io_work* work = nullptr;
+  {
+    std::lock_guard lock{self.mutex_};
+    work = std::exchange(self.completed_head_, nullptr);
+    self.completed_tail_ = nullptr;
+  }
+  while (work) {
+    io_work* next = std::exchange(work->next_, nullptr);
+    work->complete_(work, work->stopped_);
+    work = next;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+} // namespace gsenders
@@ -0,0 +1,429 @@
+#ifndef GLIB_SENDERS_IO_THREAD_POOL_HPP
+#define GLIB_SENDERS_IO_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <stdexec/execution.hpp>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+struct async_pread_t {
+  template <class Object, class... Args>
+  requires stdexec::tag_invocable<async_pread_t, Object, Args...>
+  auto operator()(Object&& pool, Args&&... args) const
+      noexcept(stdexec::nothrow_tag_invocable<async_pread_t, Object, Args...>) {
+    return tag_invoke(async_pread_t{}, std::forward<Object>(pool),
+                      std::forward<Args>(args)...);
+  }
+};
+
+struct async_pwrite_t {
+  template <class Object, class... Args>
+  requires stdexec::tag_invocable<async_pwrite_t, Object, Args...>
+  auto operator()(Object&& pool, Args&&... args) const
+      noexcept(stdexec::nothrow_tag_invocable<async_pwrite_t, Object, Args...>) {
+    return tag_invoke(async_pwrite_t{}, std::forward<Object>(pool),
+                      std::forward<Args>(args)...);
+  }
+};
+
+inline constexpr async_pread_t async_pread;
+inline constexpr async_pwrite_t async_pwrite;
+
+/// @brief One positional read of a batch.
+struct pread_request {
+  std::span<char> buffer;
+  off_t offset;
+  /// The part of the buffer that has been read.
+  std::span<char> result{};
+};
+
+/// @brief One positional write of a batch.
+struct pwrite_request {
+  std::span<const char> buffer;
+  off_t offset;
+  /// The part of the buffer that has not been written.
+  std::span<const char> result{};
+};
+
+/// @brief A unit of work that runs on an I/O thread and completes on the GLib
+/// event loop.
+struct io_work {
+  io_work* next_{nullptr};
+  void (*execute_)(io_work*) noexcept = nullptr;
+  void (*complete_)(io_work*, bool stopped) noexcept = nullptr;
+  std::atomic<bool> stop_requested_{false};
+  // Set if the work has been withdrawn before it ran. Guarded by the mutex of
+  // the pool until the work is completed.
+  bool stopped_{false};
+};
+
+/// @brief A small, bounded pool of threads for blocking system calls.
+///
+/// Regular files always poll readable, so reading them on the GLib thread
+/// blocks the event loop whenever the page cache misses. This pool runs such
+/// calls on its own threads and completes them on the context of the given
+/// scheduler. Completions that finish close together are delivered in a single
+/// dispatch of the event loop. A stop request withdraws work that has not
+/// started to run yet, such that it completes as stopped without waiting for
+/// the disk.
+class io_thread_pool {
+public:
+  static constexpr std::size_t default_thread_count = 4;
+
+  /// @brief Start the worker threads.
+  ///
+  /// @throws std::system_error if a thread cannot be started
+  explicit io_thread_pool(glib_scheduler scheduler,
+                          std::size_t thread_count = default_thread_count);
+
+  /// @brief Stop and join the worker threads.
+  ///
+  /// Work that is running is waited for. Then every pending operation is
+  /// completed on the calling thread: work that has finished with its result
+  /// and work that has not started as stopped.
+  ~io_thread_pool();
+
+  io_thread_pool(const io_thread_pool&) = delete;
+  io_thread_pool& operator=(const io_thread_pool&) = delete;
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+  /// @brief Submit a list of work items linked by their next_ pointers.
+  ///
+  /// The whole batch is queued with a single lock. Thread-safe.
+  auto submit(io_work* first) noexcept -> void;
+
+  /// @brief Withdraw a work item that has not started to run.
+  ///
+  /// The item completes as stopped on the event loop. Work that is already
+  /// running completes as usual. Thread-safe.
+  auto request_stop(io_work* work) noexcept -> void;
+
+private:
+  auto shutdown() noexcept -> void;
+  auto push_completed(io_work* work) noexcept -> bool;
+  auto run_worker() noexcept -> void;
+  static auto complete_all(gpointer data) -> gboolean;
+
+  glib_scheduler scheduler_;
+  std::mutex mutex_{};
+  std::condition_variable condition_{};
+  io_work* submitted_head_{nullptr};
+  io_work* submitted_tail_{nullptr};
+  io_work* completed_head_{nullptr};
+  io_work* completed_tail_{nullptr};
+  bool stopped_{false};
+  ::GSource* source_{nullptr};
+  std::vector<std::thread> threads_{};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+/// @brief Perform one request of a batch on an I/O thread.
+auto run_request(int fd, pread_request& request) noexcept -> std::error_code;
+
+/// @brief Perform one request of a batch on an I/O thread.
+auto run_request(int fd, pwrite_request& request) noexcept -> std::error_code;
+
+template <class Fn, class Receiver> class offload_operation : io_work {
+private:
+  using result_type = std::invoke_result_t<Fn&>;
+  using stored_result = std::conditional_t<std::is_void_v<result_type>,
+                                           std::monostate, result_type>;
+
+  io_thread_pool& pool_;
+  Fn fn_;
+  [[no_unique_address]] Receiver receiver_;
+  std::variant<std::monostate, stored_result, std::exception_ptr> result_{};
+
+  struct on_stop_requested {
+    io_thread_pool& pool_;
+    io_work& work_;
+    void operator()() noexcept { pool_.request_stop(&work_); }
+  };
+  using on_stop = std::optional<typename stdexec::stop_token_of_t<
+      stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto execute(io_work* work) noexcept -> void {
+    auto& self = *static_cast<offload_operation*>(work);
+    try {
+      if constexpr (std::is_void_v<result_type>) {
+        self.fn_();
+        self.result_.template emplace<1>();
+      } else {
+        self.result_.template emplace<1>(self.fn_());
+      }
+    } catch (...) {
+      self.result_.template emplace<2>(std::current_exception());
+    }
+  }
+
+  static auto complete(io_work* work, bool stopped) noexcept -> void {
+    auto& self = *static_cast<offload_operation*>(work);
+    self.on_stop_.reset();
+    if (stopped) {
+      stdexec::set_stopped(std::move(self.receiver_));
+    } else if (self.result_.index() == 1) {
+      if constexpr (std::is_void_v<result_type>) {
+        stdexec::set_value(std::move(self.receiver_));
+      } else {
+        stdexec::set_value(std::move(self.receiver_),
+                           std::move(std::get<1>(self.result_)));
+      }
+    } else {
+      stdexec::set_error(std::move(self.receiver_),
+                         std::move(std::get<2>(self.result_)));
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t, offload_operation& self) noexcept
+      -> void {
+    // A stop request that arrives before the work is queued is seen by the
+    // worker, which withdraws the work instead of running it.
+    self.on_stop_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
+        on_stop_requested{self.pool_, self});
+    self.pool_.submit(&self);
+  }
+
+public:
+  offload_operation(io_thread_pool& pool, Fn fn, Receiver&& receiver)
+      : pool_{pool}, fn_{std::move(fn)}, receiver_{std::move(receiver)} {
+    this->execute_ = &execute;
+    this->complete_ = &complete;
+  }
+  offload_operation(offload_operation&&) = delete;
+};
+
+template <class Fn> class offload_sender {
+public:
+  using completion_signatures = stdexec::completion_signatures<
+      value_signature_t<std::invoke_result_t<Fn&>>,
+      stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+  offload_sender(io_thread_pool& pool, Fn fn)
+      : pool_{&pool}, fn_{std::move(fn)} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  io_thread_pool* pool_;
+  Fn fn_;
+
+  template <stdexec::__decays_to<offload_sender> Self, class R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, Self&& self, R&& receiver)
+      -> offload_operation<Fn, std::remove_cvref_t<R>> {
+    return {*self.pool_, std::forward<Self>(self).fn_,
+            std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const offload_sender& self) noexcept {
+    return attrs{self.pool_->get_scheduler()};
+  }
+};
+
+template <class Request, class Receiver> class batch_operation {
+  struct item : io_work {
+    batch_operation* op_{nullptr};
+    Request* request_{nullptr};
+    std::error_code error_{};
+  };
+
+  io_thread_pool& pool_;
+  int fd_;
+  std::span<Request> requests_;
+  [[no_unique_address]] Receiver receiver_;
+  std::vector<item> items_;
+  // Only touched by completions, which all run on the GLib thread.
+  std::size_t pending_{0};
+
+  struct on_stop_requested {
+    batch_operation& op_;
+    void operator()() noexcept {
+      for (item& i : op_.items_) {
+        op_.pool_.request_stop(&i);
+      }
+    }
+  };
+  using on_stop = std::optional<typename stdexec::stop_token_of_t<
+      stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto execute(io_work* work) noexcept -> void {
+    auto& self = *static_cast<item*>(work);
+    self.error_ = run_request(self.op_->fd_, *self.request_);
+  }
+
+  // Errors of requests that have run take precedence over withdrawn ones.
+  static auto complete(io_work* work, bool) noexcept -> void {
+    batch_operation& self = *static_cast<item*>(work)->op_;
+    if (--self.pending_ > 0) {
+      return;
+    }
+    self.on_stop_.reset();
+    bool stopped = false;
+    for (const item& i : self.items_) {
+      if (i.error_) {
+        stdexec::set_error(std::move(self.receiver_),
+                           std::make_exception_ptr(std::system_error(i.error_)));
+        return;
+      }
+      stopped = stopped || i.stopped_;
+    }
+    if (stopped) {
+      stdexec::set_stopped(std::move(self.receiver_));
+    } else {
+      stdexec::set_value(std::move(self.receiver_), self.requests_);
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t, batch_operation& self) noexcept
+      -> void {
+    if (self.items_.empty()) {
+      stdexec::set_value(std::move(self.receiver_), self.requests_);
+      return;
+    }
+    self.pending_ = self.items_.size();
+    for (std::size_t i = 0; i + 1 < self.items_.size(); ++i) {
+      self.items_[i].next_ = &self.items_[i + 1];
+    }
+    self.on_stop_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
+        on_stop_requested{self});
+    self.pool_.submit(&self.items_.front());
+  }
+
+public:
+  batch_operation(io_thread_pool& pool, int fd, std::span<Request> requests,
+                  Receiver&& receiver)
+      : pool_{pool}, fd_{fd}, requests_{requests},
+        receiver_{std::move(receiver)}, items_(requests.size()) {
+    for (std::size_t i = 0; i < items_.size(); ++i) {
+      items_[i].execute_ = &execute;
+      items_[i].complete_ = &complete;
+      items_[i].op_ = this;
+      items_[i].request_ = &requests[i];
+    }
+  }
+  batch_operation(batch_operation&&) = delete;
+};
+
+template <class Request> class batch_sender {
+public:
+  using completion_signatures = stdexec::completion_signatures<
+      stdexec::set_value_t(std::span<Request>),
+      stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+  batch_sender(io_thread_pool& pool, int fd,
+               std::span<Request> requests) noexcept
+      : pool_{&pool}, fd_{fd}, requests_{requests} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  io_thread_pool* pool_;
+  int fd_;
+  std::span<Request> requests_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const batch_sender& self,
+                         R&& receiver)
+      -> batch_operation<Request, std::remove_cvref_t<R>> {
+    return {*self.pool_, self.fd_, self.requests_, std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const batch_sender& self) noexcept {
+    return attrs{self.pool_->get_scheduler()};
+  }
+};
+
+/// @brief Run a blocking function on the pool and complete with its result on
+/// the GLib event loop.
+template <class Fn>
+auto offload(io_thread_pool& pool, Fn fn) -> offload_sender<Fn> {
+  return {pool, std::move(fn)};
+}
+
+inline auto tag_invoke(async_pread_t, io_thread_pool& pool, int fd,
+                       std::span<char> buffer, off_t offset) {
+  return offload(pool, [fd, buffer, offset] {
+    ssize_t nbytes = ::pread(fd, buffer.data(), buffer.size(), offset);
+    if (nbytes == -1) {
+      throw std::system_error(errno, std::system_category());
+    }
+    return buffer.subspan(0, nbytes);
+  });
+}
+
+/// Submits one work item per request in a single batch, such that the
+/// requests run in parallel on the pool. Completes with the requests once all
+/// of them have finished, or with the first error.
+inline auto tag_invoke(async_pread_t, io_thread_pool& pool, int fd,
+                       std::span<pread_request> requests) noexcept
+    -> batch_sender<pread_request> {
+  return {pool, fd, requests};
+}
+
+inline auto tag_invoke(async_pwrite_t, io_thread_pool& pool, int fd,
+                       std::span<const char> buffer, off_t offset) {
+  return offload(pool, [fd, buffer, offset] {
+    ssize_t nbytes = ::pwrite(fd, buffer.data(), buffer.size(), offset);
+    if (nbytes == -1) {
+      throw std::system_error(errno, std::system_category());
+    }
+    return buffer.subspan(nbytes);
+  });
+}
+
+/// Submits one work item per request in a single batch, such that the
+/// requests run in parallel on the pool. Completes with the requests once all
+/// of them have finished, or with the first error.
+inline auto tag_invoke(async_pwrite_t, io_thread_pool& pool, int fd,
+                       std::span<pwrite_request> requests) noexcept
+    -> batch_sender<pwrite_request> {
+  return {pool, fd, requests};
+}
+
+} // namespace gsenders
+
+#endif
@@ -0,0 +1,88 @@
+#include "glib-senders/mapped_file.hpp"
+
+#include <memory>
+#include <new>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gsenders {
+
+namespace {
+struct prefetch_request {
+  // Keeps the mapping alive if the file is destroyed in the meantime.
+  std::shared_ptr<const char> mapping;
+  const char* address;
+  std::size_t length;
+};
+
+auto page_size() noexcept -> std::size_t {
+  static const std::size_t size = ::sysconf(_SC_PAGESIZE);
+  return size;
+}
+
+// madvise(MADV_WILLNEED) may block on page table and readahead setup, so it
+// runs on a single shared helper thread.
+auto prefetch_pool() noexcept -> ::GThreadPool* {
+  static ::GThreadPool* pool = ::g_thread_pool_new(
+      [](gpointer data, gpointer) {
+        std::unique_ptr<prefetch_request> request{
+            static_cast<prefetch_request*>(data)};
+        ::madvise(const_cast<char*>(request->address), request->length,
+                  MADV_WILLNEED);
+      },
+      nullptr, 1, false, nullptr);
+  return pool;
+}
+} // namespace
+
+mapped_file::mapped_file(const char* path) {
+  safe_file_descriptor fd{::open(path, O_RDONLY | O_CLOEXEC)};
+  if (!fd) {
+    throw std::system_error(errno, std::system_category());
+  }
+  *this = mapped_file{fd};
+}
+
+mapped_file::mapped_file(const safe_file_descriptor& fd) {
+  struct ::stat status {};
+  if (::fstat(fd.get(), &status) == -1) {
+    throw std::system_error(errno, std::system_category());
+  }
+  if (status.st_size == 0) {
+    return;
+  }
+  void* address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED,
+                         fd.get(), 0);
+  if (address == MAP_FAILED) {
+    throw std::system_error(errno, std::system_category());
+  }
+  ::madvise(address, status.st_size, MADV_SEQUENTIAL);
+  std::size_t size = status.st_size;
+  // If the control block cannot be allocated, the deleter unmaps the file.
+  data_ = std::shared_ptr<const char>(
+      static_cast<const char*>(address),
+      [size](const char* data) { ::munmap(const_cast<char*>(data), size); });
+  size_ = size;
+}
+
+mapped_file::~mapped_file() = default;
+
+auto mapped_file::prefetch(std::size_t offset, std::size_t length) const noexcept
+    -> void {
+  if (offset >= size_ || length == 0) {
+    return;
+  }
+  length = std::min(length, size_ - offset);
+  std::size_t aligned = offset - offset % page_size();
+  auto* request = new (std::nothrow) prefetch_request{
+      data_, data_.get() + aligned, length + (offset - aligned)};
+  if (request && !::g_thread_pool_push(prefetch_pool(), request, nullptr)) {
+    delete request;
+  }
+}
+
+} // namespace gsenders
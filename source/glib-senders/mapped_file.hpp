@@ -0,0 +1,176 @@
+#ifndef GLIB_SENDERS_MAPPED_FILE_HPP
+#define GLIB_SENDERS_MAPPED_FILE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include <stdexec/execution.hpp>
+
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+struct async_next_window_t {
+  template <class Object>
+  requires stdexec::tag_invocable<async_next_window_t, Object>
+  auto operator()(Object&& stream) const
+      noexcept(stdexec::nothrow_tag_invocable<async_next_window_t, Object>) {
+    return tag_invoke(async_next_window_t{}, std::forward<Object>(stream));
+  }
+};
+inline constexpr async_next_window_t async_next_window;
+
+/// @brief A read-only memory mapping of a regular file.
+///
+/// The mapping is advised as sequential. Pages of upcoming regions can be
+/// requested with prefetch(), which issues the madvise call on a helper thread
+/// such that the GLib thread does not block on setting up the readahead.
+/// Prefetching is only a hint: touching a page that has not been read yet
+/// still faults on the touching thread.
+class mapped_file {
+public:
+  /// @brief Create an empty mapping.
+  mapped_file() = default;
+
+  /// @brief Open and map the file at the given path.
+  ///
+  /// @throws std::system_error if the file cannot be opened or mapped
+  explicit mapped_file(const char* path);
+
+  /// @brief Map the file referred to by the given file descriptor.
+  ///
+  /// The file descriptor can be closed after the constructor returns.
+  ///
+  /// @throws std::system_error if the file cannot be mapped
+  explicit mapped_file(const safe_file_descriptor& fd);
+
+  /// @brief Unmap the file if it is mapped.
+  ///
+  /// Prefetches that are still queued keep the mapping alive until they have
+  /// run.
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  mapped_file(mapped_file&& other) noexcept;
+  mapped_file& operator=(mapped_file&& other) noexcept;
+
+  /// @brief Get a view of the whole mapped file.
+  [[nodiscard]] auto data() const noexcept -> std::span<const char>;
+
+  /// @brief Get the size of the mapped file in bytes.
+  [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+  /// @brief Ask the kernel to read the given range ahead.
+  ///
+  /// The request is handed to a helper thread and this function returns
+  /// immediately. Ranges outside of the mapping are clamped.
+  auto prefetch(std::size_t offset, std::size_t length) const noexcept -> void;
+
+  /// @brief Check if the mapping is non-empty.
+  explicit operator bool() const noexcept;
+
+private:
+  // Shared with queued prefetch requests, the deleter unmaps the file.
+  std::shared_ptr<const char> data_{};
+  std::size_t size_{0};
+};
+
+/// @brief Exposes a mapped file as a sequence of windows.
+///
+/// Each async_next_window() hops through the scheduler and then completes
+/// with the next window of the file, or with an empty span at the end of the
+/// file. The first `readahead` windows are prefetched on construction, and
+/// handing out a window prefetches the following ones. A window is handed out
+/// whether or not its prefetch has completed.
+template <class Scheduler> class basic_mapped_file_stream {
+public:
+  static constexpr std::size_t default_window_size = 1 << 20;
+  static constexpr std::size_t default_readahead = 4;
+
+  explicit basic_mapped_file_stream(
+      const mapped_file& file, std::size_t window_size = default_window_size,
+      std::size_t readahead = default_readahead) noexcept
+  requires std::is_default_constructible_v<Scheduler>
+      : basic_mapped_file_stream(Scheduler(), file, window_size, readahead) {}
+
+  basic_mapped_file_stream(Scheduler scheduler, const mapped_file& file,
+                           std::size_t window_size = default_window_size,
+                           std::size_t readahead = default_readahead) noexcept
+      : scheduler_(std::move(scheduler)), file_(&file),
+        window_size_(std::max<std::size_t>(window_size, 1)),
+        readahead_(readahead) {
+    prefetched_until_ = std::min(file_->size(), window_size_ * readahead_);
+    file_->prefetch(0, prefetched_until_);
+  }
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> Scheduler {
+    return scheduler_;
+  }
+
+  /// @brief Get the offset of the next window within the file.
+  [[nodiscard]] auto tell() const noexcept -> std::size_t { return offset_; }
+
+  /// @brief Return the next window synchronously and advance the stream.
+  auto next_window() noexcept -> std::span<const char> {
+    std::span<const char> data = file_->data();
+    std::size_t length = std::min(window_size_, data.size() - offset_);
+    std::span<const char> window = data.subspan(offset_, length);
+    offset_ += length;
+    prefetched_until_ = std::max(prefetched_until_, offset_);
+    std::size_t target =
+        std::min(data.size(), offset_ + window_size_ * readahead_);
+    if (target > prefetched_until_) {
+      file_->prefetch(prefetched_until_, target - prefetched_until_);
+      prefetched_until_ = target;
+    }
+    return window;
+  }
+
+private:
+  [[no_unique_address]] Scheduler scheduler_;
+  const mapped_file* file_;
+  std::size_t window_size_;
+  std::size_t readahead_;
+  std::size_t offset_{0};
+  std::size_t prefetched_until_{0};
+
+  friend auto tag_invoke(async_next_window_t,
+                         basic_mapped_file_stream& self) {
+    return stdexec::schedule(self.scheduler_) |
+           stdexec::then([&self] { return self.next_window(); });
+  }
+};
+
+using mapped_file_stream = basic_mapped_file_stream<glib_scheduler>;
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+inline mapped_file::mapped_file(mapped_file&& other) noexcept
+    : data_{std::move(other.data_)}, size_{std::exchange(other.size_, 0)} {}
+
+inline auto mapped_file::operator=(mapped_file&& other) noexcept
+    -> mapped_file& {
+  mapped_file tmp{std::move(other)};
+  std::swap(data_, tmp.data_);
+  std::swap(size_, tmp.size_);
+  return *this;
+}
+
+inline auto mapped_file::data() const noexcept -> std::span<const char> {
+  return {data_.get(), size_};
+}
+
+inline auto mapped_file::size() const noexcept -> std::size_t { return size_; }
+
+inline mapped_file::operator bool() const noexcept { return size_ > 0; }
+
+} // namespace gsenders
+
+#endif
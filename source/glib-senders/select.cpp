@@ -0,0 +1,107 @@
+#include "glib-senders/select.hpp"
+
+namespace gsenders {
+
+selector::selector(glib_scheduler scheduler) : scheduler_{scheduler} {
+  source_ = make_ready_time_source(&selector::dispatch, this);
+  ::g_source_attach(source_, scheduler_.get_GMainContext());
+}
+
+selector::~selector() {
+  for (entry& e : entries_) {
+    if (e.notify_on_ready_) {
+      e.notify_on_ready_(e.object_, nullptr, nullptr);
+    }
+  }
+  ::g_source_destroy(source_);
+  ::g_source_unref(source_);
+}
+
+auto selector::add(int fd, io_condition condition) -> std::size_t {
+  entries_.reserve(entries_.size() + 1);
+  // Polled only while a select() is pending.
+  gpointer tag = ::g_source_add_unix_fd(source_, fd, ::GIOCondition{});
+  entries_.push_back(entry{tag, get_g_io_condition(condition)});
+  if (waiter_) {
+    ::g_source_modify_unix_fd(source_, tag, entries_.back().condition_);
+  }
+  return entries_.size() - 1;
+}
+
+auto selector::add_source(void* object, bool (*ready)(void*) noexcept,
+                          void (*notify_on_ready)(void*, void (*)(void*) noexcept,
+                                                  void*) noexcept)
+    -> std::size_t {
+  entries_.push_back(entry{nullptr, {}, object, ready, notify_on_ready});
+  notify_on_ready(object, &selector::on_ready, this);
+  // The source may have become ready before it has been registered.
+  on_ready(this);
+  return entries_.size() - 1;
+}
+
+auto selector::arm(select_waiter* waiter) noexcept -> void {
+  // The stop callback of the previous select() has been removed before it
+  // completed, so nothing can set the flag concurrently here.
+  stop_requested_.store(false);
+  waiter_ = waiter;
+  bool has_sources = false;
+  for (entry& e : entries_) {
+    if (e.tag_) {
+      ::g_source_modify_unix_fd(source_, e.tag_, e.condition_);
+    } else {
+      has_sources = true;
+    }
+  }
+  if (has_sources) {
+    // Sources are checked in dispatch, they may be ready already.
+    make_source_ready(source_);
+  }
+}
+
+auto selector::request_stop() noexcept -> void {
+  stop_requested_.store(true);
+  make_source_ready(source_);
+}
+
+auto selector::on_ready(void* data) noexcept -> void {
+  make_source_ready(static_cast<selector*>(data)->source_);
+}
+
+auto selector::find_ready() noexcept -> std::size_t {
+  std::size_t size = entries_.size();
+  for (std::size_t i = 0; i < size; ++i) {
+    std::size_t index = (next_ + i) % size;
+    const entry& e = entries_[index];
+    bool is_ready = e.tag_ ? ::g_source_query_unix_fd(source_, e.tag_) != 0
+                           : e.ready_(e.object_);
+    if (is_ready) {
+      next_ = index + 1;
+      return index;
+    }
+  }
+  return npos;
+}
+
+auto selector::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<selector*>(data);
+  // Disarmed before looking at the entries, such that a notification that
+  // arrives in between makes the source ready again.
+  ::g_source_set_ready_time(self.source_, -1);
+  if (!self.waiter_) {
+    return G_SOURCE_CONTINUE;
+  }
+  std::size_t index = self.stop_requested_.load() ? npos : self.find_ready();
+  if (index == npos && !self.stop_requested_.load()) {
+    return G_SOURCE_CONTINUE;
+  }
+  for (entry& e : self.entries_) {
+    if (e.tag_) {
+      ::g_source_modify_unix_fd(self.source_, e.tag_, ::GIOCondition{});
+    }
+  }
+  select_waiter* waiter = std::exchange(self.waiter_, nullptr);
+  waiter->complete_(waiter, index);
+  return G_SOURCE_CONTINUE;
+}
+
+} // namespace gsenders
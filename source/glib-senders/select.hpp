@@ -0,0 +1,199 @@
+#ifndef GLIB_SENDERS_SELECT_HPP
+#define GLIB_SENDERS_SELECT_HPP
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <stdexec/execution.hpp>
+
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+/// @brief Something that can be selected besides a file descriptor, for
+/// example a broadcast_channel subscription.
+template <class Source>
+concept selectable =
+    requires(Source& source, void (*on_ready)(void*) noexcept, void* data) {
+      { source.ready() } -> std::convertible_to<bool>;
+      source.notify_on_ready(on_ready, data);
+    };
+
+/// @brief An operation that waits for a selector.
+struct select_waiter {
+  /// Called with the index of the ready entry, or selector::npos if stopped.
+  void (*complete_)(select_waiter*, std::size_t index) noexcept = nullptr;
+};
+
+template <class Receiver> class select_operation;
+class select_sender;
+
+/// @brief Waits for whichever of a fixed set of fds and channels is ready
+/// first.
+///
+/// All entries are registered once with a single persistent GSource. Each
+/// select() only enables the polled events of the fds and disables them again
+/// after completing, such that selecting in a loop allocates nothing and sets
+/// up no stop callbacks per entry. Ready entries are served round-robin, so a
+/// busy entry cannot starve the others.
+///
+/// select() must be started on the thread that runs the context, and only one
+/// select() may be pending at a time. Added sources must outlive the
+/// selector.
+class selector {
+public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  explicit selector(glib_scheduler scheduler);
+  ~selector();
+
+  selector(const selector&) = delete;
+  selector& operator=(const selector&) = delete;
+
+  /// @brief Add a file descriptor.
+  ///
+  /// @return the index with which select() completes if the fd is ready
+  auto add(int fd, io_condition condition) -> std::size_t;
+
+  /// @brief Add a source that reports its readiness through a callback.
+  ///
+  /// @return the index with which select() completes if the source is ready
+  template <selectable Source> auto add(Source& source) -> std::size_t {
+    return add_source(
+        &source,
+        [](void* object) noexcept -> bool {
+          return static_cast<Source*>(object)->ready();
+        },
+        [](void* object, void (*on_ready)(void*) noexcept,
+           void* data) noexcept {
+          static_cast<Source*>(object)->notify_on_ready(on_ready, data);
+        });
+  }
+
+  /// @brief Get a sender that completes with the index of a ready entry.
+  ///
+  /// Readiness is level-triggered. The completing entry is not consumed, the
+  /// caller reads from it afterwards.
+  [[nodiscard]] auto select() noexcept -> select_sender;
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+private:
+  template <class Receiver> friend class select_operation;
+
+  struct entry {
+    gpointer tag_{nullptr};
+    ::GIOCondition condition_{};
+    void* object_{nullptr};
+    bool (*ready_)(void*) noexcept = nullptr;
+    void (*notify_on_ready_)(void*, void (*)(void*) noexcept,
+                             void*) noexcept = nullptr;
+  };
+
+  auto add_source(void* object, bool (*ready)(void*) noexcept,
+                  void (*notify_on_ready)(void*, void (*)(void*) noexcept,
+                                          void*) noexcept) -> std::size_t;
+  auto arm(select_waiter* waiter) noexcept -> void;
+  auto request_stop() noexcept -> void;
+  auto find_ready() noexcept -> std::size_t;
+  static auto on_ready(void* data) noexcept -> void;
+  static auto dispatch(gpointer data) -> gboolean;
+
+  glib_scheduler scheduler_;
+  ::GSource* source_{nullptr};
+  std::vector<entry> entries_{};
+  std::size_t next_{0};
+  select_waiter* waiter_{nullptr};
+  std::atomic<bool> stop_requested_{false};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+template <class Receiver> class select_operation : select_waiter {
+  selector& selector_;
+  [[no_unique_address]] Receiver receiver_;
+
+  struct on_stop_requested {
+    selector& selector_;
+    void operator()() noexcept { selector_.request_stop(); }
+  };
+  using on_stop = std::optional<typename stdexec::stop_token_of_t<
+      stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto complete(select_waiter* waiter, std::size_t index) noexcept
+      -> void {
+    auto& self = *static_cast<select_operation*>(waiter);
+    self.on_stop_.reset();
+    if (index == selector::npos) {
+      stdexec::set_stopped(std::move(self.receiver_));
+    } else {
+      stdexec::set_value(std::move(self.receiver_), index);
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t, select_operation& self) noexcept
+      -> void {
+    self.selector_.arm(&self);
+    self.on_stop_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
+        on_stop_requested{self.selector_});
+  }
+
+public:
+  select_operation(selector& sel, Receiver&& receiver)
+      : selector_{sel}, receiver_{std::move(receiver)} {
+    this->complete_ = &complete;
+  }
+  select_operation(select_operation&&) = delete;
+};
+
+class select_sender {
+public:
+  using completion_signatures =
+      stdexec::completion_signatures<stdexec::set_value_t(std::size_t),
+                                     stdexec::set_stopped_t()>;
+
+  explicit select_sender(selector& sel) noexcept : selector_{&sel} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  selector* selector_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const select_sender& self,
+                         R&& receiver)
+      -> select_operation<std::remove_cvref_t<R>> {
+    return {*self.selector_, std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const select_sender& self) noexcept {
+    return attrs{self.selector_->get_scheduler()};
+  }
+};
+
+inline auto selector::select() noexcept -> select_sender {
+  return select_sender{*this};
+}
+
+} // namespace gsenders
+
+#endif
@@ -0,0 +1,233 @@
+#include "glib-senders/shm_channel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gsenders {
+
+// The layout at the start of the memfd. The indices grow monotonically and
+// are taken modulo the capacity. Each side owns one cache line.
+struct shm_header {
+  alignas(64) std::atomic<std::uint64_t> write_index;
+  std::atomic<std::uint32_t> producer_waiting;
+  alignas(64) std::atomic<std::uint64_t> read_index;
+  std::atomic<std::uint32_t> consumer_waiting;
+  alignas(64) std::uint64_t capacity;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+                  std::atomic<std::uint32_t>::is_always_lock_free,
+              "atomics in shared memory must be lock-free");
+
+namespace {
+// Every message is preceded by its size and padded, such that the next size
+// is aligned.
+constexpr std::size_t record_alignment = 8;
+constexpr std::size_t record_header_size = 8;
+// Written instead of a size if the rest of the ring is skipped.
+constexpr std::uint32_t wrap_marker = 0xFFFF'FFFF;
+constexpr std::size_t page_size = 4096;
+// Keeps max_message_size() below the wrap marker, such that every message size
+// fits into its record header.
+constexpr std::uint64_t max_capacity = std::uint64_t{wrap_marker} * 2;
+
+constexpr auto align_up(std::size_t size, std::size_t alignment) noexcept
+    -> std::size_t {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+constexpr auto record_size(std::size_t size) noexcept -> std::size_t {
+  return align_up(record_header_size + size, record_alignment);
+}
+
+auto make_fd(int fd) -> safe_file_descriptor {
+  if (fd == -1) {
+    throw std::system_error(errno, std::system_category());
+  }
+  return safe_file_descriptor{fd};
+}
+
+auto ring(const safe_file_descriptor& doorbell) noexcept -> void {
+  std::uint64_t one = 1;
+  [[maybe_unused]] ssize_t nbytes = ::write(doorbell.get(), &one, sizeof(one));
+}
+
+auto drain(const safe_file_descriptor& doorbell) noexcept -> void {
+  std::uint64_t value = 0;
+  [[maybe_unused]] ssize_t nbytes =
+      ::read(doorbell.get(), &value, sizeof(value));
+}
+} // namespace
+
+shm_channel::shm_channel(std::size_t capacity)
+    : memfd_{make_fd(::memfd_create("glib-senders-shm", MFD_CLOEXEC))},
+      data_doorbell_{make_fd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))},
+      space_doorbell_{make_fd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))} {
+  capacity = align_up(std::max(capacity, page_size), page_size);
+  if (capacity > max_capacity) {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+  }
+  if (::ftruncate(memfd_.get(), sizeof(shm_header) + capacity) == -1) {
+    throw std::system_error(errno, std::system_category());
+  }
+  map();
+  // Begin the lifetime of the header's atomics, the peer only ever maps it.
+  header_ = ::new (static_cast<void*>(header_)) shm_header{};
+  header_->capacity = capacity;
+}
+
+shm_channel::shm_channel(handles fds)
+    : memfd_{fds.memfd}, data_doorbell_{fds.data_doorbell},
+      space_doorbell_{fds.space_doorbell} {
+  map();
+}
+
+shm_channel::~shm_channel() {
+  if (header_) {
+    ::munmap(header_, sizeof(shm_header) + capacity_);
+  }
+}
+
+auto shm_channel::map() -> void {
+  struct ::stat status {};
+  if (::fstat(memfd_.get(), &status) == -1) {
+    throw std::system_error(errno, std::system_category());
+  }
+  auto size = static_cast<std::size_t>(status.st_size);
+  if (size <= sizeof(shm_header) || size - sizeof(shm_header) > max_capacity) {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+  }
+  void* address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         memfd_.get(), 0);
+  if (address == MAP_FAILED) {
+    throw std::system_error(errno, std::system_category());
+  }
+  header_ = static_cast<shm_header*>(address);
+  data_ = static_cast<char*>(address) + sizeof(shm_header);
+  if (header_->capacity != 0 &&
+      header_->capacity != size - sizeof(shm_header)) {
+    ::munmap(address, size);
+    header_ = nullptr;
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+  }
+  capacity_ = size - sizeof(shm_header);
+}
+
+auto shm_channel::get_handles() const noexcept -> handles {
+  return {memfd_.get(), data_doorbell_.get(), space_doorbell_.get()};
+}
+
+// At most half of the ring, such that a message fits into an empty ring even
+// if the tail has to be skipped.
+auto shm_channel::max_message_size() const noexcept -> std::size_t {
+  return capacity_ / 2 - record_header_size;
+}
+
+auto shm_channel::try_reserve(std::size_t size)
+    -> std::optional<std::span<char>> {
+  if (size > max_message_size()) {
+    throw std::system_error(std::make_error_code(std::errc::message_size));
+  }
+  std::size_t needed = record_size(size);
+  std::uint64_t write_index = header_->write_index.load();
+  std::uint64_t read_index = header_->read_index.load();
+  std::uint64_t offset = write_index % capacity_;
+  std::uint64_t tail = capacity_ - offset;
+  // Messages are contiguous, skip the tail of the ring if it is too short.
+  std::uint64_t total = tail < needed ? tail + needed : needed;
+  if (capacity_ - (write_index - read_index) < total) {
+    return std::nullopt;
+  }
+  if (tail < needed) {
+    // Not visible to the consumer before the next commit().
+    std::memcpy(data_ + offset, &wrap_marker, sizeof(wrap_marker));
+    write_index += tail;
+    offset = 0;
+  }
+  reserved_index_ = write_index;
+  reserved_size_ = size;
+  return std::span<char>{data_ + offset + record_header_size, size};
+}
+
+auto shm_channel::commit(std::size_t size) noexcept -> void {
+  // A larger size would publish bytes beyond the reserved space.
+  assert(size <= reserved_size_);
+  size = std::min(size, reserved_size_);
+  // Lossless, reserved_size_ is at most max_message_size().
+  auto record_size32 = static_cast<std::uint32_t>(size);
+  std::memcpy(data_ + reserved_index_ % capacity_, &record_size32,
+              sizeof(record_size32));
+  header_->write_index.store(reserved_index_ + record_size(size));
+  if (header_->consumer_waiting.exchange(0) != 0) {
+    ring(data_doorbell_);
+  }
+}
+
+// The record headers are written by the peer process and are checked before
+// they are used, such that a corrupt ring never yields a view past the
+// mapping.
+auto shm_channel::try_receive() -> std::optional<std::span<const char>> {
+  std::uint64_t read_index = header_->read_index.load();
+  std::uint64_t write_index = 0;
+  while (read_index != (write_index = header_->write_index.load())) {
+    std::uint64_t offset = read_index % capacity_;
+    std::uint64_t available = write_index - read_index;
+    std::uint32_t size = 0;
+    std::memcpy(&size, data_ + offset, sizeof(size));
+    if (size == wrap_marker) {
+      if (capacity_ - offset > available) {
+        throw std::system_error(std::make_error_code(std::errc::bad_message));
+      }
+      read_index += capacity_ - offset;
+      advance_read_index(read_index);
+      continue;
+    }
+    std::uint64_t needed = record_size(size);
+    if (size > max_message_size() || needed > available ||
+        needed > capacity_ - offset) {
+      throw std::system_error(std::make_error_code(std::errc::bad_message));
+    }
+    received_end_ = read_index + needed;
+    return std::span<const char>{data_ + offset + record_header_size, size};
+  }
+  return std::nullopt;
+}
+
+auto shm_channel::release() noexcept -> void {
+  advance_read_index(received_end_);
+}
+
+auto shm_channel::advance_read_index(std::uint64_t index) noexcept -> void {
+  header_->read_index.store(index);
+  if (header_->producer_waiting.exchange(0) != 0) {
+    ring(space_doorbell_);
+  }
+}
+
+auto shm_producer::set_waiting(bool waiting) noexcept -> void {
+  channel_->header_->producer_waiting.store(waiting ? 1 : 0);
+}
+
+auto shm_producer::reset_doorbell() noexcept -> void {
+  drain(channel_->space_doorbell_);
+}
+
+auto shm_consumer::set_waiting(bool waiting) noexcept -> void {
+  channel_->header_->consumer_waiting.store(waiting ? 1 : 0);
+}
+
+auto shm_consumer::reset_doorbell() noexcept -> void {
+  drain(channel_->data_doorbell_);
+}
+
+} // namespace gsenders
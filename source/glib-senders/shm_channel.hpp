@@ -0,0 +1,226 @@
+#ifndef GLIB_SENDERS_SHM_CHANNEL_HPP
+#define GLIB_SENDERS_SHM_CHANNEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "glib-senders/async_event.hpp"
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+struct shm_header;
+
+/// @brief A message channel between two processes over shared memory.
+///
+/// Messages are written into a ring buffer in a memfd that is mapped by both
+/// processes, such that payloads are never copied through the kernel. Two
+/// eventfds are used as doorbells: one for the consumer to wait for messages
+/// and one for the producer to wait for space. A doorbell is only rung if the
+/// peer has announced that it is about to wait, so a busy channel exchanges
+/// messages without any system call.
+///
+/// The channel has exactly one producer and one consumer, see shm_producer
+/// and shm_consumer. Typically one process creates the channel and hands its
+/// get_handles() to the other one, either by fork() or over a unix socket. The
+/// descriptors are created with close-on-exec.
+class shm_channel {
+public:
+  static constexpr std::size_t default_capacity = 1024 * 1024;
+
+  /// @brief The file descriptors of a channel.
+  struct handles {
+    int memfd;
+    int data_doorbell;
+    int space_doorbell;
+  };
+
+  /// @brief Create a new channel whose ring buffer holds the given number of
+  /// bytes.
+  ///
+  /// @throws std::system_error if the memfd or eventfds cannot be created, or
+  /// with std::errc::invalid_argument if the capacity exceeds 8 GiB
+  explicit shm_channel(std::size_t capacity = default_capacity);
+
+  /// @brief Attach to a channel that has been created by another process.
+  ///
+  /// Takes ownership of the file descriptors.
+  ///
+  /// @throws std::system_error if the memfd cannot be mapped
+  explicit shm_channel(handles fds);
+
+  ~shm_channel();
+
+  shm_channel(const shm_channel&) = delete;
+  shm_channel& operator=(const shm_channel&) = delete;
+
+  /// @brief Get the file descriptors to hand over to the peer process.
+  [[nodiscard]] auto get_handles() const noexcept -> handles;
+
+  /// @brief Get the largest message that fits into the ring buffer.
+  [[nodiscard]] auto max_message_size() const noexcept -> std::size_t;
+
+private:
+  friend class shm_producer;
+  friend class shm_consumer;
+
+  auto map() -> void;
+
+  auto try_reserve(std::size_t size) -> std::optional<std::span<char>>;
+  auto commit(std::size_t size) noexcept -> void;
+  auto try_receive() -> std::optional<std::span<const char>>;
+  auto release() noexcept -> void;
+  auto advance_read_index(std::uint64_t index) noexcept -> void;
+
+  safe_file_descriptor memfd_;
+  safe_file_descriptor data_doorbell_;
+  safe_file_descriptor space_doorbell_;
+  shm_header* header_{nullptr};
+  char* data_{nullptr};
+  std::uint64_t capacity_{0};
+  // Local to the producer: where the reserved message starts and how many
+  // bytes of payload it has room for.
+  std::uint64_t reserved_index_{0};
+  std::size_t reserved_size_{0};
+  // Local to the consumer: where the received message ends.
+  std::uint64_t received_end_{0};
+};
+
+/// @brief The writing end of a shm_channel.
+///
+/// Messages are written in place: reserve() completes with a view of the
+/// shared memory once there is enough space, and commit() publishes the
+/// message to the consumer. Only one message can be reserved at a time.
+///
+/// The producer must be used from the thread that runs the context of its
+/// scheduler.
+class shm_producer {
+  struct reserve_policy;
+
+public:
+  shm_producer(glib_scheduler scheduler, shm_channel& channel) noexcept
+      : scheduler_{scheduler}, channel_{&channel} {}
+
+  /// @brief Get a sender that completes with a view of size bytes in the
+  /// shared memory.
+  ///
+  /// Fails with std::errc::message_size if the message can never fit.
+  [[nodiscard]] auto reserve(std::size_t size) noexcept
+      -> doorbell_sender<reserve_policy>;
+
+  /// @brief Publish the first size bytes of the reserved message.
+  ///
+  /// size must not exceed the size of the reservation.
+  auto commit(std::size_t size) noexcept -> void { channel_->commit(size); }
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+private:
+  struct reserve_policy {
+    using value_type = std::span<char>;
+
+    shm_producer* producer_;
+    std::size_t size_;
+
+    auto try_acquire() const -> std::optional<value_type> {
+      return producer_->channel_->try_reserve(size_);
+    }
+    auto set_waiting(bool waiting) const noexcept -> void {
+      producer_->set_waiting(waiting);
+    }
+    auto reset_doorbell() const noexcept -> void {
+      producer_->reset_doorbell();
+    }
+    [[nodiscard]] auto doorbell() const noexcept -> int {
+      return producer_->channel_->space_doorbell_.get();
+    }
+    [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+      return producer_->scheduler_;
+    }
+  };
+
+  auto set_waiting(bool waiting) noexcept -> void;
+  auto reset_doorbell() noexcept -> void;
+
+  glib_scheduler scheduler_;
+  shm_channel* channel_;
+};
+
+/// @brief The reading end of a shm_channel.
+///
+/// receive() completes with a view of the next message in the shared memory,
+/// which stays valid until release() is called.
+///
+/// The consumer must be used from the thread that runs the context of its
+/// scheduler.
+class shm_consumer {
+  struct receive_policy;
+
+public:
+  shm_consumer(glib_scheduler scheduler, shm_channel& channel) noexcept
+      : scheduler_{scheduler}, channel_{&channel} {}
+
+  /// @brief Get a sender that completes with a view of the next message.
+  ///
+  /// Fails with std::errc::bad_message if the ring has been corrupted, such
+  /// that a record does not fit into the data written by the producer.
+  [[nodiscard]] auto receive() noexcept -> doorbell_sender<receive_policy>;
+
+  /// @brief Hand the space of the received message back to the producer.
+  auto release() noexcept -> void { channel_->release(); }
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+private:
+  struct receive_policy {
+    using value_type = std::span<const char>;
+
+    shm_consumer* consumer_;
+
+    auto try_acquire() const -> std::optional<value_type> {
+      return consumer_->channel_->try_receive();
+    }
+    auto set_waiting(bool waiting) const noexcept -> void {
+      consumer_->set_waiting(waiting);
+    }
+    auto reset_doorbell() const noexcept -> void {
+      consumer_->reset_doorbell();
+    }
+    [[nodiscard]] auto doorbell() const noexcept -> int {
+      return consumer_->channel_->data_doorbell_.get();
+    }
+    [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+      return consumer_->scheduler_;
+    }
+  };
+
+  auto set_waiting(bool waiting) noexcept -> void;
+  auto reset_doorbell() noexcept -> void;
+
+  glib_scheduler scheduler_;
+  shm_channel* channel_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+inline auto shm_producer::reserve(std::size_t size) noexcept
+    -> doorbell_sender<reserve_policy> {
+  return doorbell_sender<reserve_policy>{reserve_policy{this, size}};
+}
+
+inline auto shm_consumer::receive() noexcept
+    -> doorbell_sender<receive_policy> {
+  return doorbell_sender<receive_policy>{receive_policy{this}};
+}
+
+} // namespace gsenders
+
+#endif
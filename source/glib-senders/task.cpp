@@ -0,0 +1,69 @@
+#include "glib-senders/task.hpp"
+
+#include <new>
+
+namespace gsenders {
+
+namespace {
+constexpr std::size_t bucket_granularity = 64;
+constexpr std::size_t bucket_count = 32;
+// Bounds the memory that is kept alive by a thread after a burst of tasks.
+constexpr std::size_t max_free_frames = 128;
+
+struct free_frame {
+  free_frame* next_;
+};
+
+// Set once the pool of the thread has been destroyed. Frames that are freed
+// later on, e.g. by the destructors of other thread_local objects, go straight
+// to the global allocator. Being trivially destructible, the flag itself stays
+// valid until the thread is gone.
+thread_local bool pool_destroyed = false;
+
+struct frame_pool {
+  free_frame* free_lists_[bucket_count]{};
+  std::size_t free_counts_[bucket_count]{};
+
+  ~frame_pool() {
+    pool_destroyed = true;
+    for (free_frame* head : free_lists_) {
+      while (head) {
+        ::operator delete(std::exchange(head, head->next_));
+      }
+    }
+  }
+};
+
+thread_local frame_pool pool{};
+
+auto bucket_of(std::size_t size) noexcept -> std::size_t {
+  return (size - 1) / bucket_granularity;
+}
+} // namespace
+
+auto allocate_task_frame(std::size_t size) -> void* {
+  std::size_t bucket = bucket_of(size);
+  if (bucket >= bucket_count || pool_destroyed) {
+    return ::operator new(size);
+  }
+  if (free_frame* frame = pool.free_lists_[bucket]) {
+    pool.free_lists_[bucket] = frame->next_;
+    pool.free_counts_[bucket] -= 1;
+    return frame;
+  }
+  return ::operator new((bucket + 1) * bucket_granularity);
+}
+
+auto deallocate_task_frame(void* pointer, std::size_t size) noexcept -> void {
+  std::size_t bucket = bucket_of(size);
+  if (bucket >= bucket_count || pool_destroyed ||
+      pool.free_counts_[bucket] >= max_free_frames) {
+    ::operator delete(pointer);
+    return;
+  }
+  auto* frame = ::new (pointer) free_frame{pool.free_lists_[bucket]};
+  pool.free_lists_[bucket] = frame;
+  pool.free_counts_[bucket] += 1;
+}
+
+} // namespace gsenders
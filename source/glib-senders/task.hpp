@@ -0,0 +1,458 @@
+#ifndef GLIB_SENDERS_TASK_HPP
+#define GLIB_SENDERS_TASK_HPP
+
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <stdexec/execution.hpp>
+#include <stdexec/stop_token.hpp>
+
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+/// @brief Allocate a coroutine frame from the free lists of the calling thread.
+///
+/// Frames are pooled in size buckets per thread. A frame may be freed on
+/// another thread than it has been allocated on, it then joins the pool of
+/// that thread. After the pool of a thread has been destroyed, its frames are
+/// allocated and freed by the global allocator.
+auto allocate_task_frame(std::size_t size) -> void*;
+
+/// @brief Return a coroutine frame to the free lists of the calling thread.
+auto deallocate_task_frame(void* pointer, std::size_t size) noexcept -> void;
+
+/// @brief A lazy coroutine task for the GLib event loop.
+///
+/// Compared to a generic task this type
+///
+///  - allocates its frames with allocate_task_frame(),
+///  - resumes an awaiting task by symmetric transfer, and
+///  - continues without suspending if an awaited sender completes inline.
+///    A sender whose completion scheduler is the scheduler of the task resumes
+///    it directly, all others are rescheduled onto it.
+///
+/// The scheduler and stop token are taken from the awaiting coroutine or the
+/// receiver the task is connected to. Without a glib_scheduler in the
+/// environment the task runs on the default context.
+template <class T = void> class task;
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+template <class T> inline constexpr bool is_task_v = false;
+template <class T> inline constexpr bool is_task_v<task<T>> = true;
+
+template <class Sender>
+concept completes_on_glib_scheduler =
+    stdexec::sender<Sender> && requires(const Sender& sender) {
+      {
+        stdexec::get_completion_scheduler<stdexec::set_value_t>(
+            stdexec::get_env(sender))
+        } -> std::same_as<glib_scheduler>;
+    };
+
+// Only the scheduler is compared, not its type, since senders of another
+// context complete on its thread.
+template <class Sender>
+auto completes_on(const Sender& sender,
+                  const glib_scheduler& scheduler) noexcept -> bool {
+  if constexpr (completes_on_glib_scheduler<Sender>) {
+    return stdexec::get_completion_scheduler<stdexec::set_value_t>(
+               stdexec::get_env(sender)) == scheduler;
+  } else {
+    return false;
+  }
+}
+
+struct task_env {
+  glib_scheduler scheduler_;
+  stdexec::in_place_stop_token stop_token_;
+
+  friend auto tag_invoke(stdexec::get_scheduler_t, const task_env& self) noexcept
+      -> glib_scheduler {
+    return self.scheduler_;
+  }
+
+  friend auto tag_invoke(stdexec::get_stop_token_t,
+                         const task_env& self) noexcept
+      -> stdexec::in_place_stop_token {
+    return self.stop_token_;
+  }
+};
+
+template <class... Values> struct awaited_value;
+template <> struct awaited_value<> {
+  using type = void;
+};
+template <class Value> struct awaited_value<Value> {
+  using type = std::decay_t<Value>;
+};
+template <class... Values>
+using awaited_value_t = typename awaited_value<Values...>::type;
+
+template <class... Types> struct single_type;
+template <class Type> struct single_type<Type> {
+  using type = Type;
+};
+template <class... Types>
+using single_type_t = typename single_type<Types...>::type;
+
+// Awaits a sender from a task. A sender that completes within start() does not
+// suspend the task at all, such that a loop over such senders runs in constant
+// stack space.
+template <class Sender, class Promise> class sender_awaitable {
+  using value_type =
+      stdexec::value_types_of_t<std::remove_cvref_t<Sender>, task_env,
+                                awaited_value_t, single_type_t>;
+
+  struct no_value {};
+  struct stopped {};
+  using stored_value =
+      std::conditional_t<std::is_void_v<value_type>, no_value, value_type>;
+
+  enum class state { starting, suspended, completed };
+
+  struct receiver {
+    sender_awaitable* self_;
+
+    template <class... Values>
+    friend auto tag_invoke(stdexec::set_value_t, receiver&& self,
+                           Values&&... values) noexcept -> void {
+      try {
+        self.self_->result_.template emplace<1>(
+            std::forward<Values>(values)...);
+      } catch (...) {
+        self.self_->result_.template emplace<2>(std::current_exception());
+      }
+      self.self_->complete();
+    }
+
+    template <class Error>
+    friend auto tag_invoke(stdexec::set_error_t, receiver&& self,
+                           Error&& error) noexcept -> void {
+      if constexpr (std::same_as<std::decay_t<Error>, std::exception_ptr>) {
+        self.self_->result_.template emplace<2>(std::forward<Error>(error));
+      } else if constexpr (std::same_as<std::decay_t<Error>, std::error_code>) {
+        self.self_->result_.template emplace<2>(
+            std::make_exception_ptr(std::system_error(error)));
+      } else {
+        self.self_->result_.template emplace<2>(
+            std::make_exception_ptr(std::forward<Error>(error)));
+      }
+      self.self_->complete();
+    }
+
+    friend auto tag_invoke(stdexec::set_stopped_t, receiver&& self) noexcept
+        -> void {
+      self.self_->result_.template emplace<3>();
+      self.self_->complete();
+    }
+
+    friend auto tag_invoke(stdexec::get_env_t, const receiver& self) noexcept
+        -> task_env {
+      return stdexec::get_env(std::as_const(self.self_->promise_));
+    }
+  };
+
+  // Resumes the task on its scheduler after the result has been stored.
+  struct resume_receiver {
+    sender_awaitable* self_;
+
+    friend auto tag_invoke(stdexec::set_value_t, resume_receiver&& self) noexcept
+        -> void {
+      self.self_->resume();
+    }
+
+    template <class Error>
+    friend auto tag_invoke(stdexec::set_error_t, resume_receiver&& self,
+                           Error&&) noexcept -> void {
+      self.self_->resume();
+    }
+
+    friend auto tag_invoke(stdexec::set_stopped_t,
+                           resume_receiver&& self) noexcept -> void {
+      self.self_->resume();
+    }
+
+    friend auto tag_invoke(stdexec::get_env_t,
+                           const resume_receiver& self) noexcept -> task_env {
+      return {self.self_->scheduler_, {}};
+    }
+  };
+
+  using operation = stdexec::connect_result_t<Sender, receiver>;
+  using resume_operation =
+      stdexec::connect_result_t<schedule_sender, resume_receiver>;
+
+  Promise& promise_;
+  glib_scheduler scheduler_;
+  bool direct_;
+  std::variant<std::monostate, stored_value, std::exception_ptr, stopped>
+      result_{};
+  std::atomic<state> state_{state::starting};
+  operation op_;
+  std::optional<resume_operation> resume_{};
+
+  auto continuation() noexcept -> std::coroutine_handle<> {
+    if (result_.index() == 3) {
+      return promise_.unhandled_stopped();
+    }
+    return std::coroutine_handle<Promise>::from_promise(promise_);
+  }
+
+  auto resume() noexcept -> void { continuation().resume(); }
+
+  auto complete() noexcept -> void {
+    if (state_.exchange(state::completed) == state::starting) {
+      // Completed inline, await_suspend() continues the task.
+      return;
+    }
+    if (direct_) {
+      resume();
+      return;
+    }
+    try {
+      resume_.emplace(emplace_from{[this] {
+        return stdexec::connect(stdexec::schedule(scheduler_),
+                                resume_receiver{this});
+      }});
+      stdexec::start(*resume_);
+    } catch (...) {
+      resume();
+    }
+  }
+
+public:
+  sender_awaitable(Sender&& sender, Promise& promise,
+                   glib_scheduler scheduler)
+      : promise_{promise}, scheduler_{scheduler},
+        direct_{completes_on(sender, scheduler)},
+        op_{stdexec::connect(std::forward<Sender>(sender), receiver{this})} {}
+  sender_awaitable(sender_awaitable&&) = delete;
+
+  auto await_ready() const noexcept -> bool { return false; }
+
+  auto await_suspend(std::coroutine_handle<Promise>) noexcept
+      -> std::coroutine_handle<> {
+    stdexec::start(op_);
+    if (state_.exchange(state::suspended) == state::completed) {
+      return continuation();
+    }
+    return std::noop_coroutine();
+  }
+
+  auto await_resume() -> value_type {
+    if (result_.index() == 2) {
+      std::rethrow_exception(std::get<2>(result_));
+    }
+    if constexpr (!std::is_void_v<value_type>) {
+      return std::move(std::get<1>(result_));
+    }
+  }
+};
+
+template <class T> class task_result {
+public:
+  template <class Value>
+  requires std::constructible_from<T, Value>
+  auto return_value(Value&& value) noexcept(
+      std::is_nothrow_constructible_v<T, Value>) -> void {
+    result_.template emplace<1>(std::forward<Value>(value));
+  }
+
+  auto unhandled_exception() noexcept -> void {
+    result_.template emplace<2>(std::current_exception());
+  }
+
+  auto get_result() -> T {
+    if (result_.index() == 2) {
+      std::rethrow_exception(std::get<2>(result_));
+    }
+    return std::move(std::get<1>(result_));
+  }
+
+private:
+  std::variant<std::monostate, T, std::exception_ptr> result_{};
+};
+
+template <> class task_result<void> {
+public:
+  auto return_void() noexcept -> void {}
+
+  auto unhandled_exception() noexcept -> void {
+    exception_ = std::current_exception();
+  }
+
+  auto get_result() -> void {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  std::exception_ptr exception_{};
+};
+
+template <class T> class task {
+public:
+  using completion_signatures = stdexec::completion_signatures<
+      std::conditional_t<std::is_void_v<T>, stdexec::set_value_t(),
+                         stdexec::set_value_t(T)>,
+      stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+  class promise_type : public stdexec::with_awaitable_senders<promise_type>,
+                       public task_result<T> {
+  public:
+    static auto operator new(std::size_t size) -> void* {
+      return allocate_task_frame(size);
+    }
+
+    static auto operator delete(void* pointer, std::size_t size) noexcept
+        -> void {
+      deallocate_task_frame(pointer, size);
+    }
+
+    auto get_return_object() noexcept -> task {
+      return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+    auto final_suspend() noexcept {
+      struct final_awaiter {
+        auto await_ready() const noexcept -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            -> std::coroutine_handle<> {
+          return handle.promise().continuation().handle();
+        }
+
+        auto await_resume() const noexcept -> void {}
+      };
+      return final_awaiter{};
+    }
+
+    template <class Value> auto await_transform(Value&& value) -> decltype(auto) {
+      if constexpr (is_task_v<std::remove_cvref_t<Value>>) {
+        return stdexec::as_awaitable(std::forward<Value>(value), *this);
+      } else if constexpr (stdexec::sender<Value>) {
+        return sender_awaitable<Value, promise_type>{std::forward<Value>(value),
+                                                     *this, scheduler_};
+      } else {
+        return stdexec::as_awaitable(std::forward<Value>(value), *this);
+      }
+    }
+
+  private:
+    friend class task;
+
+    glib_scheduler scheduler_{};
+    stdexec::in_place_stop_token stop_token_{};
+
+    friend auto tag_invoke(stdexec::get_env_t,
+                           const promise_type& self) noexcept -> task_env {
+      return {self.scheduler_, self.stop_token_};
+    }
+  };
+
+  task(task&& other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+
+  task& operator=(task&& other) noexcept {
+    task tmp{std::move(other)};
+    std::swap(handle_, tmp.handle_);
+    return *this;
+  }
+
+  ~task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+private:
+  class awaiter {
+  public:
+    explicit awaiter(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_{handle} {}
+
+    awaiter(awaiter&&) = delete;
+
+    ~awaiter() {
+      if (handle_) {
+        handle_.destroy();
+      }
+    }
+
+    auto await_ready() const noexcept -> bool { return false; }
+
+    template <class ParentPromise>
+    auto await_suspend(std::coroutine_handle<ParentPromise> parent)
+        -> std::coroutine_handle<> {
+      promise_type& promise = handle_.promise();
+      promise.set_continuation(parent);
+      if constexpr (stdexec::tag_invocable<stdexec::get_env_t,
+                                           const ParentPromise&>) {
+        auto&& env = stdexec::get_env(std::as_const(parent.promise()));
+        using env_t = std::remove_cvref_t<decltype(env)>;
+        if constexpr (requires {
+                        {
+                          stdexec::get_scheduler(env)
+                          } -> std::same_as<glib_scheduler>;
+                      }) {
+          promise.scheduler_ = stdexec::get_scheduler(env);
+        }
+        using stop_token_t = stdexec::stop_token_of_t<env_t>;
+        if constexpr (std::same_as<stop_token_t,
+                                   stdexec::in_place_stop_token>) {
+          promise.stop_token_ = stdexec::get_stop_token(env);
+        } else if constexpr (!stdexec::unstoppable_token<stop_token_t>) {
+          using callback_t = typename stop_token_t::template callback_type<
+              forward_stop_request>;
+          forward_stop_ = std::make_shared<callback_t>(
+              stdexec::get_stop_token(env),
+              forward_stop_request{stop_source_});
+          promise.stop_token_ = stop_source_.get_token();
+        }
+      }
+      // Symmetric transfer into the child task.
+      return handle_;
+    }
+
+    auto await_resume() -> T { return handle_.promise().get_result(); }
+
+  private:
+    struct forward_stop_request {
+      stdexec::in_place_stop_source& stop_source_;
+      void operator()() noexcept { stop_source_.request_stop(); }
+    };
+
+    std::coroutine_handle<promise_type> handle_;
+    stdexec::in_place_stop_source stop_source_{};
+    std::shared_ptr<void> forward_stop_{};
+  };
+
+public:
+  auto operator co_await() && noexcept -> awaiter {
+    return awaiter{std::exchange(handle_, {})};
+  }
+
+private:
+  explicit task(std::coroutine_handle<promise_type> handle) noexcept
+      : handle_{handle} {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+} // namespace gsenders
+
+#endif
@@ -0,0 +1,122 @@
+#include "glib-senders/trace.hpp"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <new>
+#include <system_error>
+
+#include "glib.h"
+
+namespace gsenders {
+
+namespace {
+struct trace_buffer {
+  static constexpr std::size_t capacity = 1 << 16;
+
+  std::array<trace_event, capacity> events_{};
+  std::atomic<std::uint64_t> size_{0};
+  int thread_id_{};
+  trace_buffer* next_{nullptr};
+};
+
+// Buffers are linked once and never freed, such that events of threads that
+// have already exited can still be dumped.
+std::atomic<trace_buffer*> buffers{nullptr};
+std::atomic<int> next_thread_id{1};
+
+auto get_thread_buffer() noexcept -> trace_buffer* {
+  thread_local trace_buffer* buffer = [] {
+    auto* buffer = new (std::nothrow) trace_buffer{};
+    if (buffer) {
+      buffer->thread_id_ = next_thread_id.fetch_add(1);
+      buffer->next_ = buffers.load(std::memory_order_relaxed);
+      while (!buffers.compare_exchange_weak(buffer->next_, buffer,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+      }
+    }
+    return buffer;
+  }();
+  return buffer;
+}
+
+auto get_name(trace_operation operation) noexcept -> const char* {
+  switch (operation) {
+  case trace_operation::schedule:
+    return "schedule";
+  case trace_operation::wait_for:
+    return "wait_for";
+  case trace_operation::wait_until:
+    return "wait_until";
+  }
+  return "unknown";
+}
+
+auto write_event(std::FILE* file, const trace_event& event, int thread_id,
+                 const char* phase, bool& first) -> void {
+  std::fprintf(file,
+               "%s\n{\"name\":\"%s\",\"cat\":\"gsenders\",\"ph\":\"%s\","
+               "\"ts\":%lld,\"pid\":1,\"tid\":%d,\"id\":\"%p\","
+               "\"args\":{\"fd\":%d,\"condition\":%d}}",
+               first ? "" : ",", get_name(event.operation_kind_), phase,
+               static_cast<long long>(event.timestamp_), thread_id,
+               event.operation_, event.fd_, event.condition_);
+  first = false;
+}
+} // namespace
+
+auto record_trace_event(trace_operation operation_kind, trace_event_kind kind,
+                        const void* operation, int fd, int condition) noexcept
+    -> void {
+  trace_buffer* buffer = get_thread_buffer();
+  if (!buffer) {
+    return;
+  }
+  std::uint64_t size = buffer->size_.load(std::memory_order_relaxed);
+  buffer->events_[size % trace_buffer::capacity] =
+      trace_event{::g_get_monotonic_time(), operation, fd, condition,
+                  operation_kind, kind};
+  buffer->size_.store(size + 1, std::memory_order_release);
+}
+
+auto dump_chrome_trace(const char* path) -> void {
+  std::FILE* file = std::fopen(path, "w");
+  if (!file) {
+    throw std::system_error(errno, std::system_category());
+  }
+  std::fputs("{\"traceEvents\":[", file);
+  bool first = true;
+  for (trace_buffer* buffer = buffers.load(std::memory_order_acquire); buffer;
+       buffer = buffer->next_) {
+    std::uint64_t size = buffer->size_.load(std::memory_order_acquire);
+    std::uint64_t begin =
+        size > trace_buffer::capacity ? size - trace_buffer::capacity : 0;
+    for (std::uint64_t i = begin; i < size; ++i) {
+      const trace_event& event = buffer->events_[i % trace_buffer::capacity];
+      int tid = buffer->thread_id_;
+      switch (event.kind_) {
+      case trace_event_kind::start:
+        write_event(file, event, tid, "b", first);
+        break;
+      case trace_event_kind::ready:
+        write_event(file, event, tid, "n", first);
+        break;
+      case trace_event_kind::dispatch_begin:
+        write_event(file, event, tid, "e", first);
+        write_event(file, event, tid, "B", first);
+        break;
+      case trace_event_kind::dispatch_end:
+        write_event(file, event, tid, "E", first);
+        break;
+      }
+    }
+  }
+  std::fputs("\n]}\n", file);
+  if (std::fclose(file) != 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+}
+
+} // namespace gsenders
@@ -0,0 +1,62 @@
+#ifndef GLIB_SENDERS_TRACE_HPP
+#define GLIB_SENDERS_TRACE_HPP
+
+#include <cstdint>
+
+namespace gsenders {
+
+/// @brief True if the library has been configured with GLIB_SENDERS_TRACING.
+///
+/// Without it all trace points compile to nothing.
+#ifdef GLIB_SENDERS_TRACING
+inline constexpr bool tracing_enabled = true;
+#else
+inline constexpr bool tracing_enabled = false;
+#endif
+
+enum class trace_operation : std::uint8_t { schedule, wait_for, wait_until };
+
+enum class trace_event_kind : std::uint8_t {
+  /// The operation has been started.
+  start,
+  /// The file descriptor of the operation has been polled ready.
+  ready,
+  /// The completion of the operation begins on the event loop.
+  dispatch_begin,
+  /// The completion of the operation has returned.
+  dispatch_end
+};
+
+/// @brief A timestamped lifecycle event of an operation.
+struct trace_event {
+  /// Monotonic time in microseconds
+  std::int64_t timestamp_;
+  /// Identifies the operation, it is never dereferenced.
+  const void* operation_;
+  int fd_;
+  int condition_;
+  trace_operation operation_kind_;
+  trace_event_kind kind_;
+};
+
+/// @brief Record an event into the ring buffer of the calling thread.
+///
+/// Each thread owns a fixed-size ring buffer which is written without locks.
+/// When a buffer is full the oldest events are overwritten.
+auto record_trace_event(trace_operation operation_kind, trace_event_kind kind,
+                        const void* operation, int fd = -1,
+                        int condition = 0) noexcept -> void;
+
+/// @brief Write all recorded events as a Chrome trace JSON file.
+///
+/// The file can be opened with chrome://tracing or https://ui.perfetto.dev.
+/// The time between start and dispatch of an operation becomes an async slice,
+/// the dispatch itself a slice on the thread that ran it. Events of threads
+/// that are recording concurrently may be torn, so dump from a quiet point.
+///
+/// @throws std::system_error if the file cannot be written
+auto dump_chrome_trace(const char* path) -> void;
+
+} // namespace gsenders
+
+#endif
@@ -0,0 +1,218 @@
+#include "glib-senders/write_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+
+#include <sys/uio.h>
+
+namespace gsenders {
+
+namespace {
+// Small messages are appended to chunks of this size, such that a writev
+// gathers them with few iovecs.
+constexpr std::size_t chunk_size = 16 * 1024;
+constexpr std::size_t max_iovecs = 64;
+} // namespace
+
+auto write_queue::waiter_list::push(write_waiter* waiter) noexcept -> void {
+  waiter->next_ = nullptr;
+  if (tail_) {
+    tail_->next_ = waiter;
+  } else {
+    head_ = waiter;
+  }
+  tail_ = waiter;
+}
+
+auto write_queue::waiter_list::pop() noexcept -> write_waiter* {
+  write_waiter* waiter = head_;
+  head_ = waiter->next_;
+  if (!head_) {
+    tail_ = nullptr;
+  }
+  waiter->next_ = nullptr;
+  return waiter;
+}
+
+write_queue::write_queue(glib_scheduler scheduler, int fd,
+                         std::size_t low_watermark, std::size_t high_watermark)
+    : scheduler_{scheduler}, fd_{fd}, low_watermark_{low_watermark},
+      high_watermark_{std::max(low_watermark, high_watermark)} {
+  source_ = make_ready_time_source(&write_queue::dispatch, this);
+  // G_IO_OUT is only polled while data is queued, see append() and update().
+  tag_ = ::g_source_add_unix_fd(source_, fd_, ::GIOCondition{});
+  ::g_source_attach(source_, scheduler_.get_GMainContext());
+}
+
+write_queue::~write_queue() {
+  ::g_source_destroy(source_);
+  ::g_source_unref(source_);
+}
+
+auto write_queue::start(write_waiter* waiter) noexcept -> void {
+  if (error_) {
+    waiter->complete_(waiter, error_, false);
+    return;
+  }
+  if (waiter->is_flush_) {
+    if (queued_bytes_ == 0 && !sends_.head_) {
+      waiter->complete_(waiter, {}, false);
+    } else {
+      flushes_.push(waiter);
+    }
+    return;
+  }
+  if (sends_.head_ || queued_bytes_ >= high_watermark_) {
+    sends_.push(waiter);
+    return;
+  }
+  try {
+    append(waiter->data_);
+  } catch (...) {
+    waiter->complete_(waiter,
+                      std::make_error_code(std::errc::not_enough_memory), false);
+    return;
+  }
+  waiter->complete_(waiter, {}, false);
+}
+
+auto write_queue::request_stop(write_waiter* waiter) noexcept -> void {
+  waiter->stop_requested_.store(true);
+  // The waiter is removed in the next dispatch.
+  make_source_ready(source_);
+}
+
+auto write_queue::append(std::span<const char> data) -> void {
+  if (data.empty()) {
+    return;
+  }
+  if (chunks_.empty() ||
+      chunks_.back().capacity() - chunks_.back().size() < data.size()) {
+    std::vector<char>& chunk = chunks_.emplace_back();
+    chunk.reserve(std::max(chunk_size, data.size()));
+  }
+  chunks_.back().insert(chunks_.back().end(), data.begin(), data.end());
+  bool was_empty = queued_bytes_ == 0;
+  queued_bytes_ += data.size();
+  if (was_empty) {
+    ::g_source_modify_unix_fd(source_, tag_, G_IO_OUT);
+  }
+}
+
+auto write_queue::write_some() noexcept -> void {
+  while (queued_bytes_ > 0) {
+    std::array<::iovec, max_iovecs> iovecs{};
+    std::size_t count = 0;
+    std::size_t offset = front_offset_;
+    for (auto it = chunks_.begin(); it != chunks_.end() && count < max_iovecs;
+         ++it, ++count) {
+      iovecs[count].iov_base = it->data() + offset;
+      iovecs[count].iov_len = it->size() - offset;
+      offset = 0;
+    }
+    ssize_t nbytes = ::writev(fd_, iovecs.data(), static_cast<int>(count));
+    if (nbytes == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        error_ = std::error_code(errno, std::system_category());
+      }
+      return;
+    }
+    std::size_t written = static_cast<std::size_t>(nbytes);
+    queued_bytes_ -= written;
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      total += iovecs[i].iov_len;
+    }
+    while (written > 0) {
+      std::size_t remaining = chunks_.front().size() - front_offset_;
+      if (written < remaining) {
+        front_offset_ += written;
+        break;
+      }
+      written -= remaining;
+      chunks_.pop_front();
+      front_offset_ = 0;
+    }
+    if (static_cast<std::size_t>(nbytes) < total) {
+      // The fd is full, wait for the next writeable event.
+      return;
+    }
+  }
+}
+
+// Collects the waiters that can complete now and updates the polled events.
+auto write_queue::update(waiter_list& ready, waiter_list& stopped) noexcept
+    -> void {
+  auto remove_stopped = [&stopped](waiter_list& list) {
+    waiter_list remaining{};
+    while (list.head_) {
+      write_waiter* waiter = list.pop();
+      if (waiter->stop_requested_.load()) {
+        stopped.push(waiter);
+      } else {
+        remaining.push(waiter);
+      }
+    }
+    list = remaining;
+  };
+  remove_stopped(sends_);
+  remove_stopped(flushes_);
+
+  if (error_) {
+    chunks_.clear();
+    front_offset_ = 0;
+    queued_bytes_ = 0;
+    while (sends_.head_) {
+      ready.push(sends_.pop());
+    }
+    while (flushes_.head_) {
+      ready.push(flushes_.pop());
+    }
+  }
+  if (queued_bytes_ <= low_watermark_) {
+    while (sends_.head_ && queued_bytes_ < high_watermark_) {
+      write_waiter* waiter = sends_.head_;
+      try {
+        append(waiter->data_);
+      } catch (...) {
+        break;
+      }
+      ready.push(sends_.pop());
+    }
+  }
+  if (queued_bytes_ == 0 && !sends_.head_) {
+    while (flushes_.head_) {
+      ready.push(flushes_.pop());
+    }
+  }
+  ::g_source_modify_unix_fd(source_, tag_,
+                            queued_bytes_ > 0 ? G_IO_OUT : ::GIOCondition{});
+}
+
+auto write_queue::dispatch(gpointer data) -> gboolean {
+  auto& self = *static_cast<write_queue*>(data);
+  ::g_source_set_ready_time(self.source_, -1);
+  if (::g_source_query_unix_fd(self.source_, self.tag_) != 0) {
+    self.write_some();
+  }
+  waiter_list ready{};
+  waiter_list stopped{};
+  self.update(ready, stopped);
+  std::error_code error = self.error_;
+  // The queue may be destroyed by a completion, it is not touched anymore.
+  while (stopped.head_) {
+    write_waiter* waiter = stopped.pop();
+    waiter->complete_(waiter, {}, true);
+  }
+  while (ready.head_) {
+    write_waiter* waiter = ready.pop();
+    waiter->complete_(waiter, error, false);
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+} // namespace gsenders
@@ -0,0 +1,229 @@
+#ifndef GLIB_SENDERS_WRITE_QUEUE_HPP
+#define GLIB_SENDERS_WRITE_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <stdexec/execution.hpp>
+
+#include "glib-senders/glib_io_context.hpp"
+
+namespace gsenders {
+
+struct async_send_t {
+  template <class Object>
+  requires stdexec::tag_invocable<async_send_t, Object, std::span<const char>>
+  auto operator()(Object&& queue, std::span<const char> buffer) const
+      noexcept(stdexec::nothrow_tag_invocable<async_send_t, Object,
+                                              std::span<const char>>) {
+    return tag_invoke(async_send_t{}, std::forward<Object>(queue), buffer);
+  }
+};
+
+inline constexpr async_send_t async_send;
+
+/// @brief A send or flush that waits for a write_queue.
+struct write_waiter {
+  write_waiter* next_{nullptr};
+  void (*complete_)(write_waiter*, std::error_code error,
+                    bool stopped) noexcept = nullptr;
+  /// The data of a send, empty for a flush.
+  std::span<const char> data_{};
+  bool is_flush_{false};
+  std::atomic<bool> stop_requested_{false};
+};
+
+class write_queue_sender;
+
+/// @brief An outbound queue that coalesces small writes to a file descriptor.
+///
+/// Data passed to async_send is copied into the queue and written with a
+/// single writev once the fd becomes writeable, together with everything else
+/// that has been queued in the meantime. Messages are written in the order in
+/// which their sends have been started.
+///
+/// A send completes as soon as its data has been queued. While more than the
+/// high watermark is queued, sends wait until the queue has drained to the low
+/// watermark. Their buffers must stay valid until they complete. After a
+/// write error all pending and future sends complete with that error.
+///
+/// The queue must be used from the thread that runs the context of its
+/// scheduler. Stop requests may come from any thread.
+class write_queue {
+public:
+  static constexpr std::size_t default_low_watermark = 16 * 1024;
+  static constexpr std::size_t default_high_watermark = 64 * 1024;
+
+  /// @brief Create a queue for a non-blocking file descriptor.
+  ///
+  /// The fd is not owned by the queue.
+  write_queue(glib_scheduler scheduler, int fd,
+              std::size_t low_watermark = default_low_watermark,
+              std::size_t high_watermark = default_high_watermark);
+
+  /// Pending sends and flushes are dropped without completing.
+  ~write_queue();
+
+  write_queue(const write_queue&) = delete;
+  write_queue& operator=(const write_queue&) = delete;
+
+  /// @brief Get a sender that completes once everything that has been sent
+  /// before has been written.
+  [[nodiscard]] auto flush() noexcept -> write_queue_sender;
+
+  /// @brief Get the number of bytes that have been queued but not written.
+  [[nodiscard]] auto queued_bytes() const noexcept -> std::size_t {
+    return queued_bytes_;
+  }
+
+  [[nodiscard]] auto get_scheduler() const noexcept -> glib_scheduler {
+    return scheduler_;
+  }
+
+private:
+  template <class Receiver> friend class write_queue_operation;
+
+  friend auto tag_invoke(async_send_t, write_queue& self,
+                         std::span<const char> buffer) noexcept
+      -> write_queue_sender;
+
+  struct waiter_list {
+    write_waiter* head_{nullptr};
+    write_waiter* tail_{nullptr};
+
+    auto push(write_waiter* waiter) noexcept -> void;
+    auto pop() noexcept -> write_waiter*;
+  };
+
+  auto start(write_waiter* waiter) noexcept -> void;
+  auto request_stop(write_waiter* waiter) noexcept -> void;
+  auto append(std::span<const char> data) -> void;
+  auto write_some() noexcept -> void;
+  auto update(waiter_list& ready, waiter_list& stopped) noexcept -> void;
+  static auto dispatch(gpointer data) -> gboolean;
+
+  glib_scheduler scheduler_;
+  int fd_;
+  std::size_t low_watermark_;
+  std::size_t high_watermark_;
+  ::GSource* source_{nullptr};
+  gpointer tag_{nullptr};
+  std::deque<std::vector<char>> chunks_{};
+  std::size_t front_offset_{0};
+  std::size_t queued_bytes_{0};
+  std::error_code error_{};
+  waiter_list sends_{};
+  waiter_list flushes_{};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Implementation
+
+template <class Receiver> class write_queue_operation : write_waiter {
+  write_queue& queue_;
+  [[no_unique_address]] Receiver receiver_;
+
+  struct on_stop_requested {
+    write_queue& queue_;
+    write_waiter& waiter_;
+    void operator()() noexcept { queue_.request_stop(&waiter_); }
+  };
+  using on_stop = std::optional<typename stdexec::stop_token_of_t<
+      stdexec::env_of_t<Receiver>&>::template callback_type<on_stop_requested>>;
+  on_stop on_stop_{};
+
+  static auto complete(write_waiter* waiter, std::error_code error,
+                       bool stopped) noexcept -> void {
+    auto& self = *static_cast<write_queue_operation*>(waiter);
+    self.on_stop_.reset();
+    if (stopped) {
+      stdexec::set_stopped(std::move(self.receiver_));
+    } else if (error) {
+      stdexec::set_error(std::move(self.receiver_),
+                         std::make_exception_ptr(std::system_error(error)));
+    } else {
+      stdexec::set_value(std::move(self.receiver_));
+    }
+  }
+
+  friend auto tag_invoke(stdexec::start_t, write_queue_operation& self) noexcept
+      -> void {
+    self.on_stop_.emplace(
+        stdexec::get_stop_token(stdexec::get_env(self.receiver_)),
+        on_stop_requested{self.queue_, self});
+    self.queue_.start(&self);
+  }
+
+public:
+  write_queue_operation(write_queue& queue, std::span<const char> data,
+                        bool is_flush, Receiver&& receiver)
+      : queue_{queue}, receiver_{std::move(receiver)} {
+    this->complete_ = &complete;
+    this->data_ = data;
+    this->is_flush_ = is_flush;
+  }
+  write_queue_operation(write_queue_operation&&) = delete;
+};
+
+class write_queue_sender {
+public:
+  using completion_signatures =
+      stdexec::completion_signatures<stdexec::set_value_t(),
+                                     stdexec::set_error_t(std::exception_ptr),
+                                     stdexec::set_stopped_t()>;
+
+  write_queue_sender(write_queue& queue, std::span<const char> data,
+                     bool is_flush) noexcept
+      : queue_{&queue}, data_{data}, is_flush_{is_flush} {}
+
+  struct attrs {
+    glib_scheduler scheduler_;
+    friend glib_scheduler
+    tag_invoke(stdexec::get_completion_scheduler_t<stdexec::set_value_t>,
+               const attrs& self) noexcept {
+      return self.scheduler_;
+    }
+  };
+
+private:
+  write_queue* queue_;
+  std::span<const char> data_;
+  bool is_flush_;
+
+  template <typename R>
+  requires stdexec::receiver<R>
+  friend auto tag_invoke(stdexec::connect_t, const write_queue_sender& self,
+                         R&& receiver)
+      -> write_queue_operation<std::remove_cvref_t<R>> {
+    return {*self.queue_, self.data_, self.is_flush_,
+            std::forward<R>(receiver)};
+  }
+
+  friend attrs tag_invoke(stdexec::get_env_t,
+                          const write_queue_sender& self) noexcept {
+    return attrs{self.queue_->get_scheduler()};
+  }
+};
+
+inline auto write_queue::flush() noexcept -> write_queue_sender {
+  return write_queue_sender{*this, {}, true};
+}
+
+/// Completes once the data has been copied into the queue.
+inline auto tag_invoke(async_send_t, write_queue& self,
+                       std::span<const char> buffer) noexcept
+    -> write_queue_sender {
+  return write_queue_sender{self, buffer, false};
+}
+
+} // namespace gsenders
+
+#endif
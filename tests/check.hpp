@@ -0,0 +1,34 @@
+#ifndef GLIB_SENDERS_TESTS_CHECK_HPP
+#define GLIB_SENDERS_TESTS_CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include <stdexec/execution.hpp>
+
+#include "glib-senders/glib_io_context.hpp"
+
+// Aborts the test with the failed condition and its location. The tests are
+// plain executables that ctest runs, a non-zero exit code fails them.
+#define CHECK(condition)                                                       \
+  do {                                                                         \
+    if (!(condition)) {                                                        \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,    \
+                   #condition);                                                \
+      std::exit(EXIT_FAILURE);                                                 \
+    }                                                                          \
+  } while (false)
+
+// Runs the loop of the context until the sender has completed on it. The
+// sender is started from the loop, such that stop() is never called before
+// run().
+template <class Sender>
+auto run_on_loop(gsenders::glib_io_context& ctx, Sender&& sender) -> void {
+  stdexec::start_detached(
+      stdexec::on(ctx.get_scheduler(), std::forward<Sender>(sender)) |
+      stdexec::then([&ctx] { ctx.stop(); }));
+  ctx.run();
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include "glib-senders/async_event.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+#include "check.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <exec/when_any.hpp>
+
+using namespace gsenders;
+using namespace std::chrono_literals;
+
+namespace {
+auto keeps_a_notification_without_waiters() -> void {
+  glib_io_context ctx{};
+  async_event event{ctx.get_scheduler()};
+  event.notify();
+  bool notified = false;
+  run_on_loop(ctx, event.wait() | stdexec::then([&] { notified = true; }));
+  CHECK(notified);
+}
+
+// The waiters are pending before the notifier thread starts, a single
+// notification has to complete all of them.
+auto completes_all_waiters() -> void {
+  glib_io_context ctx{};
+  async_event event{ctx.get_scheduler()};
+  int notified = 0;
+  std::thread notifier{};
+  auto wait = [&] { return event.wait() | stdexec::then([&] { ++notified; }); };
+  run_on_loop(ctx, stdexec::when_all(
+                       wait(), wait(), wait(),
+                       stdexec::schedule(ctx.get_scheduler()) |
+                           stdexec::then([&] {
+                             notifier = std::thread{[&] { event.notify(); }};
+                           })));
+  notifier.join();
+  CHECK(notified == 3);
+}
+
+auto counts_released_units() -> void {
+  glib_io_context ctx{};
+  async_semaphore semaphore{ctx.get_scheduler(), 1};
+  semaphore.release(2);
+  CHECK(semaphore.try_acquire());
+  CHECK(semaphore.try_acquire());
+  CHECK(semaphore.try_acquire());
+  CHECK(!semaphore.try_acquire());
+}
+
+auto acquires_inline_if_available() -> void {
+  glib_io_context ctx{};
+  async_semaphore semaphore{ctx.get_scheduler(), 1};
+  bool acquired = false;
+  stdexec::start_detached(semaphore.acquire() |
+                          stdexec::then([&] { acquired = true; }));
+  CHECK(acquired);
+  CHECK(!semaphore.try_acquire());
+}
+
+// Every unit is released separately from another thread and wakes exactly
+// one of the waiters.
+auto wakes_waiters_on_release() -> void {
+  glib_io_context ctx{};
+  async_semaphore semaphore{ctx.get_scheduler()};
+  int acquired = 0;
+  std::thread releaser{};
+  auto acquire = [&] {
+    return semaphore.acquire() | stdexec::then([&] { ++acquired; });
+  };
+  run_on_loop(ctx, stdexec::when_all(
+                       acquire(), acquire(), acquire(),
+                       stdexec::schedule(ctx.get_scheduler()) |
+                           stdexec::then([&] {
+                             releaser = std::thread{[&] {
+                               for (int i = 0; i < 3; ++i) {
+                                 semaphore.release();
+                               }
+                             }};
+                           })));
+  releaser.join();
+  CHECK(acquired == 3);
+  CHECK(!semaphore.try_acquire());
+}
+
+// Units are handed out in the order in which the waiters have started, and a
+// release wakes only as many waiters as it has units.
+auto hands_out_units_in_order() -> void {
+  glib_io_context ctx{};
+  async_semaphore semaphore{ctx.get_scheduler()};
+  std::vector<int> order{};
+  std::thread releaser{};
+  auto acquire = [&](int i) {
+    return semaphore.acquire() | stdexec::then([&, i] {
+             order.push_back(i);
+             if (order.size() == 2) {
+               CHECK((order == std::vector{0, 1}));
+               semaphore.release(2);
+             }
+           });
+  };
+  run_on_loop(ctx, stdexec::when_all(
+                       acquire(0), acquire(1), acquire(2), acquire(3),
+                       stdexec::schedule(ctx.get_scheduler()) |
+                           stdexec::then([&] {
+                             releaser =
+                                 std::thread{[&] { semaphore.release(2); }};
+                           })));
+  releaser.join();
+  CHECK((order == std::vector{0, 1, 2, 3}));
+  CHECK(!semaphore.try_acquire());
+}
+
+// A queued acquirer holds back try_acquire(), a stopped one gives up its
+// place without taking a unit.
+auto stops_a_queued_waiter() -> void {
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  async_semaphore semaphore{scheduler};
+  bool stopped = false;
+  int result = 0;
+  run_on_loop(ctx, exec::when_any(semaphore.acquire() |
+                                      stdexec::then([] { return 1; }) |
+                                      stdexec::upon_stopped([&] {
+                                        stopped = true;
+                                        return 0;
+                                      }),
+                                  exec::schedule_after(scheduler, 10ms) |
+                                      stdexec::then([&] {
+                                        CHECK(!semaphore.try_acquire());
+                                        return 2;
+                                      })) |
+                       stdexec::then([&](int value) { result = value; }));
+  CHECK(result == 2);
+  CHECK(stopped);
+  semaphore.release();
+  CHECK(semaphore.try_acquire());
+}
+} // namespace
+
+int main() {
+  keeps_a_notification_without_waiters();
+  completes_all_waiters();
+  counts_released_units();
+  acquires_inline_if_available();
+  wakes_waiters_on_release();
+  hands_out_units_in_order();
+  stops_a_queued_waiter();
+}
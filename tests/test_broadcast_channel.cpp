@@ -0,0 +1,104 @@
+#include "glib-senders/broadcast_channel.hpp"
+
+#include "check.hpp"
+
+#include <optional>
+#include <utility>
+
+using namespace gsenders;
+
+namespace {
+// Sending and receiving buffered payloads completes inline.
+auto receive(broadcast_channel<int>::subscription& subscriber)
+    -> broadcast_channel<int>::payload_type {
+  auto [payload] = stdexec::sync_wait(subscriber.receive()).value();
+  return payload;
+}
+
+auto shares_payloads_between_subscribers() -> void {
+  broadcast_channel<int> channel{};
+  auto first = channel.subscribe();
+  auto second = channel.subscribe();
+  stdexec::sync_wait(channel.send(42));
+  auto a = receive(first);
+  auto b = receive(second);
+  CHECK(*a == 42);
+  CHECK(a == b);
+}
+
+auto drops_the_oldest_payload() -> void {
+  broadcast_channel<int> channel{2, broadcast_policy::drop_oldest};
+  auto subscriber = channel.subscribe();
+  for (int i = 1; i <= 3; ++i) {
+    stdexec::sync_wait(channel.send(i));
+  }
+  CHECK(subscriber.dropped() == 1);
+  CHECK(subscriber.ready());
+  CHECK(*receive(subscriber) == 2);
+  CHECK(*receive(subscriber) == 3);
+  CHECK(!subscriber.ready());
+}
+
+auto waits_for_room_with_backpressure() -> void {
+  broadcast_channel<int> channel{1, broadcast_policy::backpressure};
+  auto subscriber = channel.subscribe();
+  stdexec::sync_wait(channel.send(1));
+  bool sent = false;
+  stdexec::start_detached(channel.send(2) |
+                          stdexec::then([&] { sent = true; }));
+  CHECK(!sent);
+  CHECK(*receive(subscriber) == 1);
+  CHECK(sent);
+  CHECK(*receive(subscriber) == 2);
+  CHECK(subscriber.dropped() == 0);
+}
+
+auto completes_a_pending_receive() -> void {
+  broadcast_channel<int> channel{};
+  auto subscriber = channel.subscribe();
+  int received = 0;
+  stdexec::start_detached(
+      subscriber.receive() |
+      stdexec::then([&](broadcast_channel<int>::payload_type payload) {
+        received = *payload;
+      }));
+  CHECK(received == 0);
+  stdexec::sync_wait(channel.send(7));
+  CHECK(received == 7);
+}
+
+auto empties_a_moved_from_subscription() -> void {
+  broadcast_channel<int> channel{1};
+  auto subscriber = channel.subscribe();
+  stdexec::sync_wait(channel.send(1));
+  stdexec::sync_wait(channel.send(2));
+  auto moved = std::move(subscriber);
+  CHECK(subscriber.dropped() == 0);
+  CHECK(!subscriber.ready());
+  CHECK(moved.dropped() == 1);
+  CHECK(moved.ready());
+  CHECK(*receive(moved) == 2);
+}
+
+// A subscriber that goes away no longer holds back senders.
+auto unsubscribes_on_destruction() -> void {
+  broadcast_channel<int> channel{1, broadcast_policy::backpressure};
+  auto subscriber = std::optional{channel.subscribe()};
+  stdexec::sync_wait(channel.send(1));
+  bool sent = false;
+  stdexec::start_detached(channel.send(2) |
+                          stdexec::then([&] { sent = true; }));
+  CHECK(!sent);
+  subscriber.reset();
+  CHECK(sent);
+}
+} // namespace
+
+int main() {
+  shares_payloads_between_subscribers();
+  drops_the_oldest_payload();
+  waits_for_room_with_backpressure();
+  completes_a_pending_receive();
+  empties_a_moved_from_subscription();
+  unsubscribes_on_destruction();
+}
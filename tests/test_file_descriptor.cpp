@@ -0,0 +1,117 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+
+#include "check.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace gsenders;
+using namespace std::chrono_literals;
+
+namespace {
+struct pipe_ends {
+  safe_file_descriptor read_end;
+  safe_file_descriptor write_end;
+};
+
+auto make_pipe() -> pipe_ends {
+  int fds[2];
+  CHECK(::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0);
+  return {safe_file_descriptor{fds[0]}, safe_file_descriptor{fds[1]}};
+}
+
+auto is_timed_out(std::exception_ptr error) -> bool {
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::system_error& e) {
+    return e.code() == std::errc::timed_out;
+  } catch (...) {
+    return false;
+  }
+}
+
+// Runs the sender and reports whether it failed with std::errc::timed_out.
+template <class Sender>
+auto times_out(glib_io_context& ctx, Sender&& sender) -> bool {
+  bool timed_out = false;
+  run_on_loop(ctx, std::forward<Sender>(sender) |
+                       stdexec::then([](auto&&...) {}) |
+                       stdexec::upon_error([&](std::exception_ptr error) {
+                         timed_out = is_timed_out(error);
+                       }));
+  return timed_out;
+}
+
+auto read_times_out_without_data() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  file_descriptor fd{ctx.get_scheduler(), pipe.read_end.get()};
+  char buffer[16];
+  CHECK(times_out(ctx, async_read_some(fd, buffer, 10ms)));
+}
+
+auto write_times_out_on_a_full_pipe() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  char chunk[4096]{};
+  while (::write(pipe.write_end.get(), chunk, sizeof(chunk)) > 0) {
+  }
+  CHECK(errno == EAGAIN);
+  file_descriptor fd{ctx.get_scheduler(), pipe.write_end.get()};
+  CHECK(times_out(ctx, async_write_some(fd, std::span<const char>{chunk},
+                                        10ms)));
+}
+
+auto wait_until_times_out() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  CHECK(times_out(ctx, wait_until(ctx.get_scheduler(), pipe.read_end.get(),
+                                  io_condition::is_readable, 10ms)));
+}
+
+// The data arrives well before the deadline.
+auto reads_data_before_the_deadline() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  file_descriptor fd{ctx.get_scheduler(), pipe.read_end.get()};
+  std::thread writer{[&] {
+    std::this_thread::sleep_for(10ms);
+    CHECK(::write(pipe.write_end.get(), "hello", 5) == 5);
+  }};
+  char buffer[16];
+  std::string received{};
+  run_on_loop(ctx, async_read_some(fd, buffer, 5s) |
+                       stdexec::then([&](std::span<char> data) {
+                         received.assign(data.data(), data.size());
+                       }));
+  writer.join();
+  CHECK(received == "hello");
+}
+
+auto wait_until_completes_before_the_deadline() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  CHECK(::write(pipe.write_end.get(), "x", 1) == 1);
+  int ready = -1;
+  run_on_loop(ctx, wait_until(ctx.get_scheduler(), pipe.read_end.get(),
+                              io_condition::is_readable, 5s) |
+                       stdexec::then([&](int fd) { ready = fd; }));
+  CHECK(ready == pipe.read_end.get());
+}
+} // namespace
+
+int main() {
+  read_times_out_without_data();
+  write_times_out_on_a_full_pipe();
+  wait_until_times_out();
+  reads_data_before_the_deadline();
+  wait_until_completes_before_the_deadline();
+}
@@ -0,0 +1,137 @@
+#include "glib-senders/glib_io_context.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using namespace gsenders;
+
+namespace {
+// Runs a function from a plain GLib source of default priority, which is
+// dispatched in the order in which it has been attached.
+auto post(glib_io_context& ctx, std::function<void()> fn) -> void {
+  ::GSource* source = ::g_idle_source_new();
+  ::g_source_set_priority(source, G_PRIORITY_DEFAULT);
+  ::g_source_set_callback(
+      source,
+      [](gpointer data) -> gboolean {
+        (*static_cast<std::function<void()>*>(data))();
+        return G_SOURCE_REMOVE;
+      },
+      new std::function<void()>(std::move(fn)),
+      [](gpointer data) { delete static_cast<std::function<void()>*>(data); });
+  ::g_source_attach(source, ctx.get_scheduler().get_GMainContext());
+  ::g_source_unref(source);
+}
+
+auto schedule_then(glib_io_context& ctx, std::function<void()> fn) -> void {
+  stdexec::start_detached(stdexec::schedule(ctx.get_scheduler()) |
+                          stdexec::then(std::move(fn)));
+}
+
+// A schedule() from a dispatch runs as soon as the dispatch returns, before
+// sources that have become ready in the meantime.
+auto runs_inline_after_the_dispatch() -> void {
+  glib_io_context ctx{};
+  std::vector<int> order{};
+  schedule_then(ctx, [&] {
+    post(ctx, [&] {
+      order.push_back(2);
+      ctx.stop();
+    });
+    schedule_then(ctx, [&] { order.push_back(1); });
+    order.push_back(0);
+  });
+  ctx.run();
+  CHECK((order == std::vector{0, 1, 2}));
+}
+
+// Schedules that have been started outside of a dispatch wait for their
+// GSource. One that is started from a dispatch must not overtake them.
+auto does_not_overtake_pending_schedules() -> void {
+  glib_io_context ctx{};
+  std::vector<int> order{};
+  schedule_then(ctx, [&] {
+    order.push_back(0);
+    schedule_then(ctx, [&] {
+      order.push_back(2);
+      ctx.stop();
+    });
+  });
+  schedule_then(ctx, [&] { order.push_back(1); });
+  ctx.run();
+  CHECK((order == std::vector{0, 1, 2}));
+}
+
+// At most 64 operations run after one dispatch. The rest moves to a new
+// source, which is attached after the sources that are already ready.
+auto moves_the_excess_to_a_new_source() -> void {
+  glib_io_context ctx{};
+  std::vector<int> order{};
+  schedule_then(ctx, [&] {
+    post(ctx, [&] { order.push_back(-1); });
+    for (int i = 0; i < 100; ++i) {
+      schedule_then(ctx, [&, i] {
+        order.push_back(i);
+        if (i == 99) {
+          ctx.stop();
+        }
+      });
+    }
+  });
+  ctx.run();
+  std::vector<int> expected{};
+  for (int i = 0; i < 64; ++i) {
+    expected.push_back(i);
+  }
+  expected.push_back(-1);
+  for (int i = 64; i < 100; ++i) {
+    expected.push_back(i);
+  }
+  CHECK(order == expected);
+}
+
+// Every step of the chain starts the next one from its completion. The steps
+// run one after another from the queue instead of nesting on the stack.
+struct chain {
+  glib_io_context& ctx_;
+  int remaining_;
+  std::uintptr_t first_frame_{0};
+  std::uintptr_t max_depth_{0};
+
+  auto step() -> void {
+    char marker{};
+    auto frame = reinterpret_cast<std::uintptr_t>(&marker);
+    if (first_frame_ == 0) {
+      first_frame_ = frame;
+    }
+    std::uintptr_t depth =
+        first_frame_ > frame ? first_frame_ - frame : frame - first_frame_;
+    max_depth_ = std::max(max_depth_, depth);
+    if (--remaining_ == 0) {
+      ctx_.stop();
+      return;
+    }
+    schedule_then(ctx_, [this] { step(); });
+  }
+};
+
+auto trampolines_long_chains() -> void {
+  glib_io_context ctx{};
+  chain c{ctx, 100'000};
+  schedule_then(ctx, [&] { c.step(); });
+  ctx.run();
+  CHECK(c.remaining_ == 0);
+  CHECK(c.max_depth_ < 64 * 1024);
+}
+} // namespace
+
+int main() {
+  runs_inline_after_the_dispatch();
+  does_not_overtake_pending_schedules();
+  moves_the_excess_to_a_new_source();
+  trampolines_long_chains();
+}
@@ -0,0 +1,56 @@
+#include "glib-senders/glib_io_context.hpp"
+
+#include "check.hpp"
+
+#include <chrono>
+
+#include <exec/when_any.hpp>
+
+using namespace gsenders;
+using namespace std::chrono_literals;
+
+namespace {
+auto runs_when_the_loop_is_idle() -> void {
+  glib_io_context ctx{};
+  idle_scheduler idle = ctx.get_idle_scheduler();
+  bool ran = false;
+  run_on_loop(ctx, stdexec::schedule(idle) | stdexec::then([&] { ran = true; }));
+  CHECK(ran);
+}
+
+// A default-priority source that is always ready keeps the loop from ever
+// becoming idle. The stop request that when_any sends once the timer fires
+// must still complete the idle operation.
+auto stops_on_a_busy_loop() -> void {
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  idle_scheduler idle = ctx.get_idle_scheduler();
+  ::GSource* busy = ::g_idle_source_new();
+  ::g_source_set_priority(busy, G_PRIORITY_DEFAULT);
+  ::g_source_set_callback(
+      busy, [](gpointer) -> gboolean { return G_SOURCE_CONTINUE; }, nullptr,
+      nullptr);
+  ::g_source_attach(busy, scheduler.get_GMainContext());
+
+  bool idle_stopped = false;
+  int result = 0;
+  run_on_loop(ctx, exec::when_any(stdexec::schedule(idle) |
+                                      stdexec::then([] { return 1; }) |
+                                      stdexec::upon_stopped([&] {
+                                        idle_stopped = true;
+                                        return 0;
+                                      }),
+                                  exec::schedule_after(scheduler, 10ms) |
+                                      stdexec::then([] { return 2; })) |
+                       stdexec::then([&](int value) { result = value; }));
+  ::g_source_destroy(busy);
+  ::g_source_unref(busy);
+  CHECK(result == 2);
+  CHECK(idle_stopped);
+}
+} // namespace
+
+int main() {
+  runs_when_the_loop_is_idle();
+  stops_on_a_busy_loop();
+}
@@ -0,0 +1,177 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/io_thread_pool.hpp"
+
+#include "check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <semaphore>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <exec/when_any.hpp>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace gsenders;
+using namespace std::chrono_literals;
+
+namespace {
+// A temporary file that is unlinked right away.
+auto make_file(std::string_view contents) -> safe_file_descriptor {
+  char path[] = "/tmp/glib-senders-test-XXXXXX";
+  safe_file_descriptor fd{::mkstemp(path)};
+  CHECK(fd);
+  ::unlink(path);
+  CHECK(::write(fd.get(), contents.data(), contents.size()) ==
+        static_cast<ssize_t>(contents.size()));
+  return fd;
+}
+
+auto reads_at_an_offset() -> void {
+  glib_io_context ctx{};
+  io_thread_pool pool{ctx.get_scheduler()};
+  safe_file_descriptor fd = make_file("hello world");
+  char buffer[16];
+  std::string received{};
+  run_on_loop(ctx, async_pread(pool, fd.get(), buffer, 6) |
+                       stdexec::then([&](std::span<char> data) {
+                         received.assign(data.data(), data.size());
+                       }));
+  CHECK(received == "world");
+}
+
+auto reads_a_batch() -> void {
+  glib_io_context ctx{};
+  io_thread_pool pool{ctx.get_scheduler(), 2};
+  safe_file_descriptor fd = make_file("0123456789");
+  char first[3];
+  char second[3];
+  char third[8];
+  pread_request requests[] = {{first, 0}, {second, 5}, {third, 8}};
+  std::size_t completed = 0;
+  run_on_loop(ctx, async_pread(pool, fd.get(), std::span{requests}) |
+                       stdexec::then([&](std::span<pread_request> batch) {
+                         completed = batch.size();
+                       }));
+  CHECK(completed == 3);
+  CHECK(std::string_view(requests[0].result.data(),
+                         requests[0].result.size()) == "012");
+  CHECK(std::string_view(requests[1].result.data(),
+                         requests[1].result.size()) == "567");
+  CHECK(std::string_view(requests[2].result.data(),
+                         requests[2].result.size()) == "89");
+}
+
+auto offloads_values_void_and_errors() -> void {
+  glib_io_context ctx{};
+  io_thread_pool pool{ctx.get_scheduler()};
+  int value = 0;
+  std::atomic<bool> ran{false};
+  bool failed = false;
+  run_on_loop(
+      ctx, stdexec::when_all(
+               offload(pool, [] { return 42; }) |
+                   stdexec::then([&](int result) { value = result; }),
+               offload(pool, [&] { ran = true; }),
+               offload(pool, []() -> int { throw std::runtime_error{"x"}; }) |
+                   stdexec::then([](int) {}) |
+                   stdexec::upon_error([&](std::exception_ptr) {
+                     failed = true;
+                   })));
+  CHECK(value == 42);
+  CHECK(ran);
+  CHECK(failed);
+}
+
+// The only worker is blocked, so the second operation is still queued when
+// the timer stops it. It must complete without ever running.
+template <class Sender>
+auto check_withdrawn(glib_io_context& ctx, io_thread_pool& pool,
+                     std::binary_semaphore& gate, Sender&& sender) -> void {
+  glib_scheduler scheduler = ctx.get_scheduler();
+  bool stopped = false;
+  int result = 0;
+  run_on_loop(
+      ctx,
+      stdexec::when_all(
+          offload(pool, [&] { gate.acquire(); }),
+          exec::when_any(std::forward<Sender>(sender) |
+                             stdexec::then([](auto&&...) { return 1; }) |
+                             stdexec::upon_stopped([&] {
+                               stopped = true;
+                               return 0;
+                             }),
+                         exec::schedule_after(scheduler, 10ms) |
+                             stdexec::then([] { return 2; })) |
+              stdexec::then([&](int value) {
+                result = value;
+                gate.release();
+              })));
+  CHECK(result == 2);
+  CHECK(stopped);
+}
+
+auto withdraws_a_queued_offload() -> void {
+  glib_io_context ctx{};
+  io_thread_pool pool{ctx.get_scheduler(), 1};
+  std::binary_semaphore gate{0};
+  std::atomic<bool> ran{false};
+  check_withdrawn(ctx, pool, gate, offload(pool, [&] { ran = true; }));
+  CHECK(!ran);
+}
+
+auto withdraws_a_queued_batch() -> void {
+  glib_io_context ctx{};
+  io_thread_pool pool{ctx.get_scheduler(), 1};
+  safe_file_descriptor fd = make_file("0123456789");
+  std::binary_semaphore gate{0};
+  char first[3];
+  char second[3];
+  pread_request requests[] = {{first, 0}, {second, 5}};
+  check_withdrawn(ctx, pool, gate,
+                  async_pread(pool, fd.get(), std::span{requests}));
+  CHECK(requests[0].result.empty());
+  CHECK(requests[1].result.empty());
+}
+
+// Destroying the pool completes queued work as stopped, and work that has
+// run with its result, instead of dropping them.
+auto completes_pending_work_on_shutdown() -> void {
+  glib_io_context ctx{};
+  std::optional<io_thread_pool> pool{std::in_place, ctx.get_scheduler(), 1};
+  std::binary_semaphore gate{0};
+  bool blocker_completed = false;
+  bool stopped = false;
+  std::atomic<bool> ran{false};
+  stdexec::start_detached(offload(*pool, [&] { gate.acquire(); }) |
+                          stdexec::then([&] { blocker_completed = true; }) |
+                          stdexec::upon_stopped([&] {
+                            blocker_completed = true;
+                          }));
+  stdexec::start_detached(offload(*pool, [&] { ran = true; }) |
+                          stdexec::upon_stopped([&] { stopped = true; }));
+  std::thread releaser{[&] {
+    std::this_thread::sleep_for(10ms);
+    gate.release();
+  }};
+  pool.reset();
+  releaser.join();
+  CHECK(blocker_completed);
+  CHECK(stopped);
+  CHECK(!ran);
+}
+} // namespace
+
+int main() {
+  reads_at_an_offset();
+  reads_a_batch();
+  offloads_values_void_and_errors();
+  withdraws_a_queued_offload();
+  withdraws_a_queued_batch();
+  completes_pending_work_on_shutdown();
+}
@@ -0,0 +1,95 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/mapped_file.hpp"
+#include "glib-senders/task.hpp"
+
+#include "check.hpp"
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <unistd.h>
+
+using namespace gsenders;
+
+namespace {
+// A temporary file that is unlinked right away and only reachable through
+// its descriptor.
+auto make_file(std::string_view contents) -> safe_file_descriptor {
+  char path[] = "/tmp/glib-senders-test-XXXXXX";
+  safe_file_descriptor fd{::mkstemp(path)};
+  CHECK(fd);
+  ::unlink(path);
+  CHECK(::write(fd.get(), contents.data(), contents.size()) ==
+        static_cast<ssize_t>(contents.size()));
+  return fd;
+}
+
+auto make_contents(std::size_t size) -> std::string {
+  std::string contents(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) {
+    contents[i] = static_cast<char>('a' + i % 26);
+  }
+  return contents;
+}
+
+task<void> read_windows(mapped_file_stream& stream, std::string& received,
+                        int& windows) {
+  while (true) {
+    std::span<const char> window = co_await async_next_window(stream);
+    if (window.empty()) {
+      break;
+    }
+    received.append(window.data(), window.size());
+    ++windows;
+    CHECK(stream.tell() == received.size());
+  }
+}
+
+auto maps_the_whole_file() -> void {
+  std::string contents = make_contents(10000);
+  mapped_file file{make_file(contents)};
+  CHECK(file);
+  CHECK(file.size() == contents.size());
+  CHECK(std::string_view(file.data().data(), file.size()) == contents);
+}
+
+auto maps_an_empty_file() -> void {
+  mapped_file file{make_file({})};
+  CHECK(!file);
+  CHECK(file.data().empty());
+}
+
+// The last window is shorter, every window has to be handed out in order.
+auto streams_windows_in_order() -> void {
+  std::string contents = make_contents(10000);
+  mapped_file file{make_file(contents)};
+  glib_io_context ctx{};
+  mapped_file_stream stream{ctx.get_scheduler(), file, 4096, 2};
+  std::string received{};
+  int windows = 0;
+  run_on_loop(ctx, read_windows(stream, received, windows));
+  CHECK(windows == 3);
+  CHECK(received == contents);
+}
+
+// The queued prefetches keep the mapping alive after the file is gone.
+auto outlives_queued_prefetches() -> void {
+  std::string contents = make_contents(1 << 20);
+  for (int i = 0; i < 100; ++i) {
+    mapped_file file{make_file(contents)};
+    file.prefetch(0, file.size());
+    mapped_file moved{std::move(file)};
+    CHECK(!file);
+    CHECK(moved.size() == contents.size());
+  }
+}
+} // namespace
+
+int main() {
+  maps_the_whole_file();
+  maps_an_empty_file();
+  streams_windows_in_order();
+  outlives_queued_prefetches();
+}
@@ -0,0 +1,110 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/select.hpp"
+#include "glib-senders/task.hpp"
+
+#include "check.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <exec/when_any.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace gsenders;
+using namespace std::chrono_literals;
+
+namespace {
+struct pipe_ends {
+  safe_file_descriptor read_end;
+  safe_file_descriptor write_end;
+};
+
+auto make_pipe() -> pipe_ends {
+  int fds[2];
+  CHECK(::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0);
+  return {safe_file_descriptor{fds[0]}, safe_file_descriptor{fds[1]}};
+}
+
+auto make_readable(const pipe_ends& pipe) -> void {
+  CHECK(::write(pipe.write_end.get(), "x", 1) == 1);
+}
+
+task<void> select_times(selector& sel, int count,
+                        std::vector<std::size_t>& selected) {
+  for (int i = 0; i < count; ++i) {
+    selected.push_back(co_await sel.select());
+  }
+}
+
+// Both pipes stay readable, since nothing reads from them. Each select()
+// continues after the entry that completed the previous one.
+auto serves_ready_entries_round_robin() -> void {
+  glib_io_context ctx{};
+  pipe_ends first = make_pipe();
+  pipe_ends second = make_pipe();
+  make_readable(first);
+  make_readable(second);
+  selector sel{ctx.get_scheduler()};
+  std::size_t a = sel.add(first.read_end.get(), io_condition::is_readable);
+  std::size_t b = sel.add(second.read_end.get(), io_condition::is_readable);
+  std::vector<std::size_t> selected{};
+  run_on_loop(ctx, select_times(sel, 4, selected));
+  CHECK((selected == std::vector{a, b, a, b}));
+}
+
+// A readable fd must not wake up the loop while no select() is pending,
+// neither before the first one nor after one has completed.
+auto polls_fds_only_while_selecting() -> void {
+  glib_io_context ctx{};
+  ::GMainContext* context = ctx.get_scheduler().get_GMainContext();
+  pipe_ends pipe = make_pipe();
+  make_readable(pipe);
+  selector sel{ctx.get_scheduler()};
+  std::size_t index = sel.add(pipe.read_end.get(), io_condition::is_readable);
+  CHECK(!::g_main_context_iteration(context, FALSE));
+  std::vector<std::size_t> selected{};
+  run_on_loop(ctx, select_times(sel, 1, selected));
+  CHECK((selected == std::vector{index}));
+  CHECK(!::g_main_context_iteration(context, FALSE));
+}
+
+// A pending select() completes with set_stopped, and the selector can be
+// used again afterwards.
+auto stops_a_pending_select() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  selector sel{ctx.get_scheduler()};
+  std::size_t index = sel.add(pipe.read_end.get(), io_condition::is_readable);
+  bool stopped = false;
+  int result = 0;
+  run_on_loop(ctx, exec::when_any(sel.select() |
+                                      stdexec::then([](std::size_t) {
+                                        return 1;
+                                      }) |
+                                      stdexec::upon_stopped([&] {
+                                        stopped = true;
+                                        return 0;
+                                      }),
+                                  exec::schedule_after(ctx.get_scheduler(),
+                                                       10ms) |
+                                      stdexec::then([] { return 2; })) |
+                       stdexec::then([&](int value) { result = value; }));
+  CHECK(result == 2);
+  CHECK(stopped);
+
+  make_readable(pipe);
+  std::vector<std::size_t> selected{};
+  run_on_loop(ctx, select_times(sel, 1, selected));
+  CHECK((selected == std::vector{index}));
+}
+} // namespace
+
+int main() {
+  serves_ready_entries_round_robin();
+  polls_fds_only_while_selecting();
+  stops_a_pending_select();
+}
@@ -0,0 +1,224 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/shm_channel.hpp"
+#include "glib-senders/task.hpp"
+
+#include "check.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace gsenders;
+using namespace std::chrono_literals;
+
+namespace {
+// With space available, reserve() and receive() complete inline, so no loop
+// has to run.
+auto send(shm_producer& producer, const std::string& payload) -> void {
+  auto [message] = stdexec::sync_wait(producer.reserve(payload.size())).value();
+  CHECK(message.size() == payload.size());
+  std::memcpy(message.data(), payload.data(), payload.size());
+  producer.commit(payload.size());
+}
+
+auto receive(shm_consumer& consumer) -> std::string {
+  auto [message] = stdexec::sync_wait(consumer.receive()).value();
+  std::string payload{message.data(), message.size()};
+  consumer.release();
+  return payload;
+}
+
+// Records of 1008 bytes leave a 64 byte tail at the end of a 4096 byte ring,
+// which is skipped with a wrap marker on every fourth message.
+auto wraps_around() -> void {
+  glib_io_context ctx{};
+  shm_channel channel{4096};
+  shm_producer producer{ctx.get_scheduler(), channel};
+  shm_consumer consumer{ctx.get_scheduler(), channel};
+  for (int i = 0; i < 40; ++i) {
+    std::string first(1000, static_cast<char>('a' + i % 26));
+    std::string second(1000, static_cast<char>('A' + i % 26));
+    send(producer, first);
+    send(producer, second);
+    CHECK(receive(consumer) == first);
+    CHECK(receive(consumer) == second);
+  }
+}
+
+auto commits_a_shorter_message() -> void {
+  glib_io_context ctx{};
+  shm_channel channel{4096};
+  shm_producer producer{ctx.get_scheduler(), channel};
+  shm_consumer consumer{ctx.get_scheduler(), channel};
+  for (int i = 0; i < 20; ++i) {
+    auto [message] = stdexec::sync_wait(producer.reserve(1500)).value();
+    std::memcpy(message.data(), "hello", 5);
+    producer.commit(5);
+    CHECK(receive(consumer) == "hello");
+  }
+}
+
+auto rejects_oversized_messages() -> void {
+  glib_io_context ctx{};
+  shm_channel channel{4096};
+  shm_producer producer{ctx.get_scheduler(), channel};
+  try {
+    stdexec::sync_wait(producer.reserve(channel.max_message_size() + 1));
+    CHECK(false);
+  } catch (const std::system_error& error) {
+    CHECK(error.code() == std::errc::message_size);
+  }
+}
+
+// The size in front of a payload is written by the peer process and must not
+// be trusted.
+auto rejects_a_corrupt_record() -> void {
+  glib_io_context ctx{};
+  shm_channel channel{4096};
+  shm_producer producer{ctx.get_scheduler(), channel};
+  shm_consumer consumer{ctx.get_scheduler(), channel};
+  auto [message] = stdexec::sync_wait(producer.reserve(16)).value();
+  producer.commit(16);
+  // The record header precedes the payload.
+  std::uint32_t corrupt = 1 << 20;
+  std::memcpy(message.data() - 8, &corrupt, sizeof(corrupt));
+  try {
+    stdexec::sync_wait(consumer.receive());
+    CHECK(false);
+  } catch (const std::system_error& error) {
+    CHECK(error.code() == std::errc::bad_message);
+  }
+}
+
+auto rejects_an_oversized_capacity() -> void {
+  try {
+    shm_channel channel{std::size_t{1} << 34};
+    CHECK(false);
+  } catch (const std::system_error& error) {
+    CHECK(error.code() == std::errc::invalid_argument);
+  }
+}
+
+task<void> send_later(glib_scheduler scheduler, shm_producer& producer,
+                      std::string payload) {
+  co_await exec::schedule_after(scheduler, 10ms);
+  std::span<char> message = co_await producer.reserve(payload.size());
+  std::memcpy(message.data(), payload.data(), payload.size());
+  producer.commit(payload.size());
+}
+
+task<void> receive_later(glib_scheduler scheduler, shm_consumer& consumer,
+                         std::string& received) {
+  co_await exec::schedule_after(scheduler, 10ms);
+  std::span<const char> message = co_await consumer.receive();
+  received.assign(message.data(), message.size());
+  consumer.release();
+}
+
+// receive() on an empty ring and reserve() on a full one wait for the
+// doorbell, which the peer rings once it makes progress.
+auto waits_for_the_doorbells() -> void {
+  glib_io_context ctx{};
+  glib_scheduler scheduler = ctx.get_scheduler();
+  shm_channel channel{4096};
+  shm_producer producer{scheduler, channel};
+  shm_consumer consumer{scheduler, channel};
+
+  std::string received{};
+  run_on_loop(ctx, stdexec::when_all(
+                       consumer.receive() |
+                           stdexec::then([&](std::span<const char> message) {
+                             received.assign(message.data(), message.size());
+                             consumer.release();
+                           }),
+                       send_later(scheduler, producer, "ping")));
+  CHECK(received == "ping");
+
+  // Two records of 2008 bytes leave no room for a third one.
+  std::string first(2000, 'a');
+  std::string second(2000, 'b');
+  std::string third(2000, 'c');
+  send(producer, first);
+  send(producer, second);
+  bool reserved = false;
+  run_on_loop(ctx, stdexec::when_all(
+                       producer.reserve(third.size()) |
+                           stdexec::then([&](std::span<char> message) {
+                             reserved = true;
+                             std::memcpy(message.data(), third.data(),
+                                         third.size());
+                             producer.commit(third.size());
+                           }),
+                       receive_later(scheduler, consumer, received)));
+  CHECK(reserved);
+  CHECK(received == first);
+  CHECK(receive(consumer) == second);
+  CHECK(receive(consumer) == third);
+}
+
+task<void> echo(shm_consumer& requests, shm_producer& responses) {
+  while (true) {
+    std::span<const char> request = co_await requests.receive();
+    std::string payload{request.data(), request.size()};
+    requests.release();
+    std::span<char> response = co_await responses.reserve(payload.size());
+    std::memcpy(response.data(), payload.data(), payload.size());
+    responses.commit(payload.size());
+    if (payload.empty()) {
+      break;
+    }
+  }
+}
+
+task<void> round_trip(shm_producer& requests, shm_consumer& responses) {
+  for (int i = 0; i <= 500; ++i) {
+    // Ends with an empty message, which stops the child.
+    std::string payload(i == 500 ? 0 : 1 + i * 7 % 1500,
+                        static_cast<char>('a' + i % 26));
+    std::span<char> request = co_await requests.reserve(payload.size());
+    std::memcpy(request.data(), payload.data(), payload.size());
+    requests.commit(payload.size());
+    std::span<const char> response = co_await responses.receive();
+    CHECK(std::string(response.data(), response.size()) == payload);
+    responses.release();
+  }
+}
+
+// Both channels are created before the fork and inherited by the child, which
+// echoes every message back.
+auto round_trips_between_processes() -> void {
+  shm_channel to_child{4096};
+  shm_channel to_parent{4096};
+  pid_t pid = ::fork();
+  CHECK(pid != -1);
+  if (pid == 0) {
+    glib_io_context ctx{};
+    shm_consumer requests{ctx.get_scheduler(), to_child};
+    shm_producer responses{ctx.get_scheduler(), to_parent};
+    run_on_loop(ctx, echo(requests, responses));
+    ::_exit(0);
+  }
+  glib_io_context ctx{};
+  shm_producer requests{ctx.get_scheduler(), to_child};
+  shm_consumer responses{ctx.get_scheduler(), to_parent};
+  run_on_loop(ctx, round_trip(requests, responses));
+  int status = 0;
+  CHECK(::waitpid(pid, &status, 0) == pid);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+} // namespace
+
+int main() {
+  wraps_around();
+  commits_a_shorter_message();
+  rejects_oversized_messages();
+  rejects_a_corrupt_record();
+  rejects_an_oversized_capacity();
+  waits_for_the_doorbells();
+  round_trips_between_processes();
+}
@@ -0,0 +1,127 @@
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/task.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <thread>
+
+#include <exec/static_thread_pool.hpp>
+
+using namespace gsenders;
+
+namespace {
+auto stack_address() noexcept -> std::uintptr_t {
+  char marker{};
+  return reinterpret_cast<std::uintptr_t>(&marker);
+}
+
+auto distance(std::uintptr_t a, std::uintptr_t b) noexcept -> std::uintptr_t {
+  return a > b ? a - b : b - a;
+}
+
+// Bounds the stack growth of loops that would otherwise nest one frame per
+// iteration.
+constexpr std::uintptr_t max_stack_growth = 64 * 1024;
+
+// Senders that complete within start() continue the task without suspending.
+task<void> awaits_inline_completions(int& sum, std::uintptr_t& growth) {
+  std::uintptr_t first = stack_address();
+  for (int i = 0; i < 100'000; ++i) {
+    sum += co_await stdexec::just(1);
+    growth = std::max(growth, distance(first, stack_address()));
+  }
+}
+
+auto resumes_inline_completions() -> void {
+  glib_io_context ctx{};
+  int sum = 0;
+  std::uintptr_t growth = 0;
+  run_on_loop(ctx, awaits_inline_completions(sum, growth));
+  CHECK(sum == 100'000);
+  CHECK(growth < max_stack_growth);
+}
+
+task<int> child(int value) { co_return value; }
+
+// Starting a child and resuming its parent transfer control symmetrically,
+// such that a loop over children that complete synchronously does not nest.
+task<void> awaits_children(int& sum, std::uintptr_t& growth) {
+  std::uintptr_t first = stack_address();
+  for (int i = 0; i < 100'000; ++i) {
+    sum += co_await child(1);
+    growth = std::max(growth, distance(first, stack_address()));
+  }
+}
+
+auto transfers_symmetrically() -> void {
+  glib_io_context ctx{};
+  int sum = 0;
+  std::uintptr_t growth = 0;
+  run_on_loop(ctx, awaits_children(sum, growth));
+  CHECK(sum == 100'000);
+  CHECK(growth < max_stack_growth);
+}
+
+task<int> nested(int depth) {
+  if (depth == 0) {
+    co_return 0;
+  }
+  co_return 1 + co_await nested(depth - 1);
+}
+
+task<void> awaits_nested(int& result) { result = co_await nested(10'000); }
+
+auto unwinds_deep_nesting() -> void {
+  glib_io_context ctx{};
+  int result = 0;
+  run_on_loop(ctx, awaits_nested(result));
+  CHECK(result == 10'000);
+}
+
+// A sender that completes on another thread reschedules the task onto the
+// loop.
+task<void> hops_to_the_pool(exec::static_thread_pool& pool,
+                            std::thread::id& on_pool,
+                            std::thread::id& resumed_on) {
+  co_await (stdexec::schedule(pool.get_scheduler()) |
+            stdexec::then([&] { on_pool = std::this_thread::get_id(); }));
+  resumed_on = std::this_thread::get_id();
+}
+
+auto reschedules_onto_the_loop() -> void {
+  glib_io_context ctx{};
+  exec::static_thread_pool pool{1};
+  std::thread::id on_pool{};
+  std::thread::id resumed_on{};
+  run_on_loop(ctx, hops_to_the_pool(pool, on_pool, resumed_on));
+  CHECK(on_pool != std::thread::id{});
+  CHECK(on_pool != std::this_thread::get_id());
+  CHECK(resumed_on == std::this_thread::get_id());
+}
+
+task<void> noop() { co_return; }
+
+// The held task is constructed before the frame pool of the thread and thus
+// destroyed after it. Its frame has to bypass the destroyed pool.
+auto frees_frames_after_the_pool() -> void {
+  std::thread thread{[] {
+    thread_local std::optional<task<void>> held{};
+    auto& slot = held;
+    slot.emplace(noop());
+    glib_io_context ctx{};
+    run_on_loop(ctx, noop());
+  }};
+  thread.join();
+}
+} // namespace
+
+int main() {
+  resumes_inline_completions();
+  transfers_symmetrically();
+  unwinds_deep_nesting();
+  reschedules_onto_the_loop();
+  frees_frames_after_the_pool();
+}
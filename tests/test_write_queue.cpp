@@ -0,0 +1,79 @@
+#include "glib-senders/file_descriptor.hpp"
+#include "glib-senders/glib_io_context.hpp"
+#include "glib-senders/task.hpp"
+#include "glib-senders/write_queue.hpp"
+
+#include "check.hpp"
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace gsenders;
+
+namespace {
+struct pipe_ends {
+  safe_file_descriptor read_end;
+  safe_file_descriptor write_end;
+};
+
+auto make_pipe() -> pipe_ends {
+  int fds[2];
+  CHECK(::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0);
+  return {safe_file_descriptor{fds[0]}, safe_file_descriptor{fds[1]}};
+}
+
+task<void> read_exactly(file_descriptor fd, std::size_t size,
+                        std::string& received) {
+  char buffer[4096];
+  while (received.size() < size) {
+    std::span<char> data = co_await async_read_some(fd, buffer);
+    CHECK(!data.empty());
+    received.append(data.data(), data.size());
+  }
+}
+
+auto flushes_an_empty_queue_inline() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  write_queue queue{ctx.get_scheduler(), pipe.write_end.get()};
+  bool flushed = false;
+  stdexec::start_detached(queue.flush() |
+                          stdexec::then([&] { flushed = true; }));
+  CHECK(flushed);
+}
+
+// Sends complete once queued, until the high watermark is reached. Nothing is
+// written before the loop runs.
+auto waits_above_the_high_watermark() -> void {
+  glib_io_context ctx{};
+  pipe_ends pipe = make_pipe();
+  write_queue queue{ctx.get_scheduler(), pipe.write_end.get(), 4096, 16384};
+  std::string messages[] = {std::string(10000, 'a'), std::string(10000, 'b'),
+                            std::string(10000, 'c')};
+  bool sent[3] = {};
+  for (int i = 0; i < 3; ++i) {
+    stdexec::start_detached(async_send(queue, messages[i]) |
+                            stdexec::then([&sent, i] { sent[i] = true; }));
+  }
+  CHECK(sent[0] && sent[1] && !sent[2]);
+  CHECK(queue.queued_bytes() == 20000);
+
+  std::string received{};
+  run_on_loop(ctx, stdexec::when_all(
+                       read_exactly(file_descriptor{ctx.get_scheduler(),
+                                                    pipe.read_end.get()},
+                                    30000, received),
+                       queue.flush()));
+  CHECK(sent[2]);
+  CHECK(queue.queued_bytes() == 0);
+  CHECK(received == messages[0] + messages[1] + messages[2]);
+}
+} // namespace
+
+int main() {
+  flushes_an_empty_queue_inline();
+  waits_above_the_high_watermark();
+}